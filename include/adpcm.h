@@ -0,0 +1,18 @@
+#ifndef _DECTMON_ADPCM_H
+#define _DECTMON_ADPCM_H
+
+#include <stdint.h>
+#include "../src/ccitt-adpcm/g72x.h"
+
+/*
+ * Block G.721 decoder
+ *
+ * Bit-exact with g721_decoder() from the reference implementation and
+ * operating on the same state, but decoding a whole buffer per call with
+ * the quantizer log computed using count leading zeros.
+ */
+
+extern void dect_g721_decode(struct g72x_state *state, int16_t *dst,
+			     const uint8_t *src, unsigned int len);
+
+#endif /* _DECTMON_ADPCM_H */
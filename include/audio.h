@@ -1,17 +1,197 @@
 #ifndef _DECTMON_AUDIO_H
 #define _DECTMON_AUDIO_H
 
-#include "../src/ccitt-adpcm/g72x.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <utils.h>
+#include <list.h>
+#include <codec.h>
 
+/*
+ * Audio engine
+ *
+ * The receiving cluster thread queues the B-field frames of each call to
+ * the call's audio handle together with the codec negotiated for the call.
+ * Handles with pending frames are put on a run queue served by a pool of
+ * worker threads, which decode the frames and pass the samples to the sinks
+ * attached to the handle (recorder, playback mixer, RTP stream).
+ * A handle is only processed by one worker at a time.
+ *
+ * Missing frames are detected by gaps in the frame sequence numbers and
+ * replaced by the last received frame with decreasing gain, so the sinks
+ * see a continuous stream. Each frame is classified as voice or silence
+ * by a voice activity detector before being passed to the sinks.
+ */
+
+/* One B-field per TDMA frame, up to 80 octets (G.722) or 160 samples */
+#define DECT_AUDIO_FRAME_RATE		100
+#define DECT_AUDIO_MAX_FRAME_SIZE	80
+#define DECT_AUDIO_MAX_FRAME_SAMPLES	160
+#define DECT_AUDIO_RING_SIZE		64
+#define DECT_AUDIO_MIXER_RATE		16000
+#define DECT_AUDIO_WORKERS		4
+
+/* Gaps up to this number of frames are concealed, larger ones resync */
+#define DECT_AUDIO_MAX_GAP		50
+
+/*
+ * Frames are identified by a sequence number built from the multiframe and
+ * frame number, incrementing once per TDMA frame. Comparisons must use
+ * dect_audio_seq_diff() to handle wraparound.
+ */
+#define DECT_AUDIO_SEQ_BITS		28
+#define DECT_AUDIO_SEQ_MASK		((1U << DECT_AUDIO_SEQ_BITS) - 1)
+#define DECT_AUDIO_SEQ(mfn, frame)	((((mfn) << 4) | ((frame) & 0xf)) & \
+					 DECT_AUDIO_SEQ_MASK)
+
+static inline int dect_audio_seq_diff(uint32_t a, uint32_t b)
+{
+	return (int32_t)((a - b) << (32 - DECT_AUDIO_SEQ_BITS)) >>
+	       (32 - DECT_AUDIO_SEQ_BITS);
+}
+
+static inline uint32_t dect_audio_seq_add(uint32_t seq, int n)
+{
+	return (seq + n) & DECT_AUDIO_SEQ_MASK;
+}
+
+struct dect_audio_frame {
+	uint32_t		seq;
+	const struct dect_codec	*codec;
+	uint8_t			data[DECT_AUDIO_MAX_FRAME_SIZE];
+};
+
+/**
+ * struct dect_audio_ring - single producer single consumer frame ring
+ *
+ * @tail:	producer position, written by the receiving cluster thread
+ * @head:	consumer position, written by the worker processing the handle
+ * @overruns:	number of frames dropped because the ring was full
+ * @frames:	encoded frames
+ */
+struct dect_audio_ring {
+	unsigned int		tail __aligned(64);
+	unsigned long		overruns;
+	unsigned int		head __aligned(64);
+	struct dect_audio_frame	frames[DECT_AUDIO_RING_SIZE];
+};
+
+/**
+ * struct dect_audio_plc - packet loss concealment state
+ *
+ * @valid:	@next and @last are valid
+ * @next:	expected sequence number of the next frame
+ * @lost:	number of consecutive concealed frames
+ * @concealed:	total number of concealed frames
+ * @late:	number of frames dropped for arriving out of order
+ * @samples:	number of samples in @last
+ * @last:	samples of the last received frame
+ */
+struct dect_audio_plc {
+	bool			valid;
+	uint32_t		next;
+	unsigned int		lost;
+	unsigned long		concealed;
+	unsigned long		late;
+	unsigned int		samples;
+	int16_t			last[DECT_AUDIO_MAX_FRAME_SAMPLES];
+};
+
+/*
+ * A frame contains voice when its mean absolute sample value exceeds twice
+ * the noise floor and DECT_VAD_MIN_LEVEL. Voice is assumed to continue for
+ * DECT_VAD_HANGOVER frames to avoid clipping word endings.
+ */
+#define DECT_VAD_MIN_LEVEL		64
+#define DECT_VAD_HANGOVER		20
+
+/**
+ * struct dect_audio_vad - voice activity detection state
+ *
+ * @noise:	noise floor estimate
+ * @hangover:	remaining frames until silence is declared
+ * @frames:	total number of frames
+ * @active:	number of frames classified as voice
+ */
+struct dect_audio_vad {
+	unsigned int		noise;
+	unsigned int		hangover;
+	unsigned long		frames;
+	unsigned long		active;
+};
+
+struct dect_audio_sink;
+
+/**
+ * struct dect_audio_sink_ops - audio sink operations
+ *
+ * @write:	process the @n decoded samples of the frame @seq of one
+ *		direction, the sample rate is @n * DECT_AUDIO_FRAME_RATE,
+ *		@voice is false for silent frames
+ * @flush:	optional, called after all frames pending on the handle
+ *		have been written
+ * @close:	release the sink once the handle is closed
+ *
+ * All are invoked from a worker thread.
+ */
+struct dect_audio_sink_ops {
+	void	(*write)(struct dect_audio_sink *sink, unsigned int dir,
+			 uint32_t seq, const int16_t *samples, unsigned int n,
+			 bool voice);
+	void	(*flush)(struct dect_audio_sink *sink);
+	void	(*close)(struct dect_audio_sink *sink);
+};
+
+struct dect_audio_sink {
+	struct list_head			list;
+	const struct dect_audio_sink_ops	*ops;
+};
+
+/**
+ * struct dect_audio_handle - audio state of a call
+ *
+ * @list:	run queue node
+ * @queued:	handle is on the run queue
+ * @running:	handle is being processed by a worker
+ * @closed:	handle was closed, released by the worker after the last run
+ * @sinks:	attached sinks
+ * @codec:	codec of the last decoded frame per direction
+ * @state:	decoder state per direction
+ * @plc:	loss concealment state per direction
+ * @vad:	voice activity detection state per direction
+ * @ring:	frame ring per direction
+ *
+ * @list, @queued, @running and @closed are protected by the pool lock,
+ * @queued is additionally read without it when queueing frames.
+ */
 struct dect_audio_handle {
-	struct g72x_state	codec[2];
-	struct dect_msg_buf	*queue[2];
+	struct list_head	list;
+	bool			queued;
+	bool			running;
+	bool			closed;
+	struct list_head	sinks;
+	const struct dect_codec	*codec[2];
+	union dect_codec_state	state[2];
+	struct dect_audio_plc	plc[2];
+	struct dect_audio_vad	vad[2];
+	struct dect_audio_ring	ring[2];
 };
 
-extern int dect_audio_init(void);
+extern int dect_audio_init(bool playback);
+extern void dect_audio_exit(void);
+
 extern struct dect_audio_handle *dect_audio_open(void);
 extern void dect_audio_close(struct dect_audio_handle *ah);
+extern void dect_audio_add_sink(struct dect_audio_handle *ah,
+				struct dect_audio_sink *sink);
 extern void dect_audio_queue(struct dect_audio_handle *ah, unsigned int queue,
-			     struct dect_msg_buf *mb);
+			     uint32_t seq, const struct dect_codec *codec,
+			     const uint8_t *data);
+
+extern unsigned int dect_audio_resample(int16_t *dst, unsigned int dn,
+					const int16_t *src, unsigned int sn,
+					int16_t *prev);
+
+extern struct dect_audio_sink *dect_audio_mixer_open(void);
 
 #endif /* _DECTMON_AUDIO_H */
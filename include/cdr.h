@@ -0,0 +1,95 @@
+#ifndef _DECTMON_CDR_H
+#define _DECTMON_CDR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <utils.h>
+
+/*
+ * Call detail records
+ *
+ * A record is started by the CC-SETUP of a call and completed when the
+ * call is released, the PT loses its last bearer or its state is expired.
+ * Bearers established for the PMID of a PT are added to its call, a lost
+ * last bearer only completes the record if no new one is established
+ * within DECT_CDR_BEARER_GRACE seconds.
+ * Completed records are written to the CSV file given with --cdr and to
+ * the binary event log. All times are in microseconds since the epoch.
+ */
+
+#define DECT_CDR_IPUI_LEN	13
+#define DECT_CDR_NUMBER_LEN	32
+#define DECT_CDR_BEARER_GRACE	2
+
+/**
+ * enum dect_cdr_causes - call record completion causes
+ *
+ * @DECT_CDR_CAUSE_RELEASE:	CC-RELEASE or CC-RELEASE-COM
+ * @DECT_CDR_CAUSE_BEARER:	last bearer of the PT released
+ * @DECT_CDR_CAUSE_EXPIRE:	PT state discarded
+ */
+enum dect_cdr_causes {
+	DECT_CDR_CAUSE_RELEASE,
+	DECT_CDR_CAUSE_BEARER,
+	DECT_CDR_CAUSE_EXPIRE,
+};
+
+/**
+ * struct dect_cdr - call detail record
+ *
+ * @setup:	time of CC-SETUP
+ * @connect:	time of CC-CONNECT, zero if the call was never connected
+ * @end:	time of call completion, set when the last bearer is lost
+ * @ipui:	IPEI of the PT
+ * @number:	called number collected from keypad IEs
+ * @slot1:	slot of the last bearer
+ * @slot2:	paired slot of the last bearer
+ * @bearers:	number of bearers used, more than one indicates handovers
+ * @ciphered:	ciphering was enabled during the call
+ * @cause:	completion cause
+ */
+struct dect_cdr {
+	uint64_t			setup;
+	uint64_t			connect;
+	uint64_t			end;
+	char				ipui[DECT_CDR_IPUI_LEN + 1];
+	char				number[DECT_CDR_NUMBER_LEN + 1];
+	uint8_t				slot1;
+	uint8_t				slot2;
+	uint8_t				bearers;
+	uint8_t				ciphered;
+	uint8_t				cause;
+} __packed;
+
+static inline const char *dect_cdr_cause_name(uint8_t cause)
+{
+	switch (cause) {
+	case DECT_CDR_CAUSE_RELEASE:
+		return "release";
+	case DECT_CDR_CAUSE_BEARER:
+		return "bearer";
+	case DECT_CDR_CAUSE_EXPIRE:
+		return "expire";
+	default:
+		return "unknown";
+	}
+}
+
+struct dect_handle;
+struct dect_pt;
+struct dect_tbc;
+
+extern int dect_cdr_open(const char *name);
+extern void dect_cdr_close(void);
+
+extern void dect_cdr_setup(struct dect_pt *pt);
+extern void dect_cdr_keypad(struct dect_pt *pt, const uint8_t *info,
+			    unsigned int len);
+extern void dect_cdr_connect(struct dect_pt *pt);
+extern void dect_cdr_bearer(struct dect_pt *pt, const struct dect_tbc *tbc);
+extern void dect_cdr_bearer_lost(struct dect_pt *pt);
+extern void dect_cdr_cipher(struct dect_pt *pt);
+extern void dect_cdr_release(struct dect_handle *dh, struct dect_pt *pt,
+			     enum dect_cdr_causes cause);
+
+#endif /* _DECTMON_CDR_H */
@@ -31,8 +31,9 @@ extern void scanner_destroy(struct parser_state *state);
 
 extern void scanner_push_buffer(void *scanner, const char *buffer);
 
-extern void cli_display(const char *fmt, va_list ap);
+extern void cli_write(const char *buf, size_t len);
 extern int cli_init(FILE *file);
+extern int cli_init_headless(const char *ctlpath);
 extern void cli_exit(void);
 
 #endif /* DECTMON_CLI_H */
@@ -0,0 +1,39 @@
+#ifndef _DECTMON_CODEC_H
+#define _DECTMON_CODEC_H
+
+#include <stdint.h>
+#include <dect/libdect.h>
+#include <g722.h>
+#include "../src/ccitt-adpcm/g72x.h"
+
+union dect_codec_state {
+	struct g72x_state	g721;
+	struct dect_g722_state	g722;
+};
+
+/**
+ * struct dect_codec - speech codec
+ *
+ * @id:			codec identifier used in the codec list IE
+ * @name:		name
+ * @rate:		sample rate
+ * @frame_size:		B-field octets per TDMA frame
+ * @frame_samples:	samples per TDMA frame
+ * @init:		initialize decoder state
+ * @decode:		decode @len octets
+ */
+struct dect_codec {
+	enum dect_codecs	id;
+	const char		*name;
+	unsigned int		rate;
+	unsigned int		frame_size;
+	unsigned int		frame_samples;
+	void			(*init)(union dect_codec_state *state);
+	void			(*decode)(union dect_codec_state *state,
+					  int16_t *dst, const uint8_t *src,
+					  unsigned int len);
+};
+
+extern const struct dect_codec *dect_codec_lookup(enum dect_codecs id);
+
+#endif /* _DECTMON_CODEC_H */
@@ -4,17 +4,20 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 #include <list.h>
 #include <dect/libdect.h>
 #include <dect/timer.h>
 #include <dect/auth.h>
 #include <phl.h>
+#include <scan.h>
 
 enum {
 	DECTMON_DUMP_MAC	= 0x1,
 	DECTMON_DUMP_DLC	= 0x2,
 	DECTMON_DUMP_NWK	= 0x4,
 	DECTMON_DUMP_AUDIO	= 0x8,
+	DECTMON_DUMP_HEX	= 0x10,
 };
 
 extern const char *auth_pin;
@@ -22,26 +25,51 @@ extern uint32_t dumpopts;
 extern uint32_t debug_mask;
 
 extern void dectmon_log(const char *fmt, ...);
+extern void dectmon_log_buf(const char *buf, unsigned int len);
 extern void dect_hexdump(const char *prefix, const uint8_t *buf, size_t size);
 
+/*
+ * PTs are indexed by IPUI in a per-cluster hash and kept on a list in LRU
+ * order. PTs not referenced by an active bearer are expired after
+ * DECT_PT_TIMEOUT seconds of inactivity or when the number of PTs exceeds
+ * DECT_PT_MAX.
+ */
+#define DECT_PT_HASH_BITS	10
+#define DECT_PT_HASH_SIZE	(1 << DECT_PT_HASH_BITS)
+#define DECT_PT_MAX		4096
+#define DECT_PT_TIMEOUT		3600
+
 extern struct list_head dect_handles;
+extern void dect_handles_lock(void);
+extern void dect_handles_unlock(void);
 
 struct dect_handle_priv {
 	struct list_head			list;
+	struct hlist_node			name_node;
 	const char				*cluster;
+	unsigned int				index;
 	struct dect_handle			*dh;
+	struct dect_loop			*loop;
 
 	struct dect_timer			*lock_timer;
 	bool					locked;
 	struct dect_ari				pari;
+	struct dect_scan_receiver		scan;
 
 	struct dect_fd				*rawsk;
 	struct list_head			pt_list;
+	struct list_head			pt_release_list;
+	struct hlist_head			pt_hash[DECT_PT_HASH_SIZE];
+	unsigned int				npt;
 	struct dect_tbc				*slots[DECT_FRAME_SIZE];
 };
 
 extern struct dect_handle_priv *dect_handle_get_by_name(const char *name);
 
+extern void dectmon_cluster_attach(const char *name);
+extern void dectmon_cluster_detach(const char *name);
+extern void dectmon_cluster_commit(void);
+
 enum dect_mm_procedures {
 	DECT_MM_NONE,
 	DECT_MM_KEY_ALLOCATION,
@@ -51,13 +79,22 @@ enum dect_mm_procedures {
 
 struct dect_pt {
 	struct list_head			list;
+	struct hlist_node			hnode;
+	unsigned int				use;
+	time_t					last_seen;
 	struct dect_ie_portable_identity	*portable_identity;
 	struct dect_dl				*dl;
+	uint32_t				pmid;
+	struct dect_timer			*release_timer;
+	struct list_head			release_list;
 
 	uint8_t					uak[DECT_AUTH_KEY_LEN];
 	uint8_t					dck[DECT_CIPHER_KEY_LEN];
 
 	struct dect_audio_handle		*ah;
+	const struct dect_codec			*codec;
+	const struct dect_codec			*codec_pending;
+	struct dect_cdr				*cdr;
 
 	enum dect_mm_procedures			procedure;
 	uint8_t					last_msg;
@@ -82,6 +119,10 @@ extern void dect_dl_data_ind(struct dect_handle *dh, struct dect_dl *dl,
 extern void dect_dl_u_data_ind(struct dect_handle *dh, struct dect_dl *dl,
 			       bool dir, struct dect_msg_buf *mb);
 
+extern void dect_dl_establish(struct dect_handle *dh, struct dect_dl *dl);
+extern void dect_dl_release(struct dect_handle *dh, struct dect_dl *dl);
+extern void dect_pt_flush(struct dect_handle *dh);
+
 struct dect_lc {
 	uint16_t				lsig;
 	struct dect_msg_buf			*rx_buf;
@@ -126,5 +167,6 @@ struct dect_tbc {
 };
 
 extern void dect_mac_rcv(struct dect_handle *dh, struct dect_msg_buf *mb);
+extern void dect_tbc_flush(struct dect_handle *dh);
 
 #endif /* _DECTMON_H */
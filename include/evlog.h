@@ -0,0 +1,111 @@
+#ifndef _DECTMON_EVLOG_H
+#define _DECTMON_EVLOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <utils.h>
+
+/*
+ * Binary event log
+ *
+ * The file starts with a struct dect_evlog_file_hdr, followed by records
+ * consisting of a struct dect_evlog_hdr and a type specific payload. All
+ * fields are stored in host byte order.
+ */
+
+#define DECT_EVLOG_MAGIC		"DECTMON"
+#define DECT_EVLOG_VERSION		1
+
+struct dect_evlog_file_hdr {
+	char				magic[7];
+	uint8_t				version;
+} __packed;
+
+/**
+ * enum dect_evlog_types - event record types
+ *
+ * @DECT_EV_CLUSTER:	cluster index to name mapping
+ * @DECT_EV_MAC:	A-field of a received frame
+ * @DECT_EV_BEARER:	traffic bearer event
+ * @DECT_EV_NWK:	NWK layer message including raw IEs
+ * @DECT_EV_CDR:	call detail record (struct dect_cdr)
+ */
+enum dect_evlog_types {
+	DECT_EV_CLUSTER,
+	DECT_EV_MAC,
+	DECT_EV_BEARER,
+	DECT_EV_NWK,
+	DECT_EV_CDR,
+};
+
+struct dect_evlog_hdr {
+	uint8_t				type;
+	uint8_t				cluster;
+	uint16_t			len;
+	uint32_t			frame;
+	uint64_t			tstamp;
+} __packed;
+
+#define DECT_EV_FRAME(mfn, frame)	(((mfn) << 4) | ((frame) & 0xf))
+#define DECT_EV_FRAME_MFN(f)		((f) >> 4)
+#define DECT_EV_FRAME_NUM(f)		((f) & 0xf)
+
+#define DECT_EV_A_FIELD_SIZE		8
+
+struct dect_ev_mac {
+	uint8_t				slot;
+	uint8_t				data[DECT_EV_A_FIELD_SIZE];
+} __packed;
+
+enum dect_ev_bearer_events {
+	DECT_EV_BEARER_ESTABLISH,
+	DECT_EV_BEARER_RELEASE,
+	DECT_EV_BEARER_TIMEOUT,
+	DECT_EV_BEARER_CIPHER,
+};
+
+struct dect_ev_bearer {
+	uint8_t				event;
+	uint8_t				slot1;
+	uint8_t				slot2;
+	uint8_t				ciphered;
+	uint32_t			pmid;
+	uint16_t			fmid;
+} __packed;
+
+struct dect_ev_nwk {
+	uint32_t			pmid;
+	uint8_t				slot;
+	uint8_t				data[];
+} __packed;
+
+extern int dect_evlog_fd;
+
+extern int dect_evlog_open(const char *name);
+extern void dect_evlog_init(void);
+extern void dect_evlog_close(void);
+
+struct dect_msg_buf;
+struct dect_tbc;
+struct dect_cdr;
+
+extern void __dect_evlog_cluster(uint8_t cluster, const char *name);
+extern void __dect_evlog_mac(uint8_t cluster, const struct dect_msg_buf *mb);
+extern void __dect_evlog_bearer(uint8_t cluster, enum dect_ev_bearer_events event,
+				const struct dect_tbc *tbc);
+extern void __dect_evlog_nwk(uint8_t cluster, const struct dect_tbc *tbc,
+			     const struct dect_msg_buf *mb);
+extern void __dect_evlog_cdr(uint8_t cluster, const struct dect_cdr *cdr);
+
+static inline bool dect_evlog_enabled(void)
+{
+	return dect_evlog_fd >= 0;
+}
+
+#define dect_evlog(type, args...)				\
+	do {							\
+		if (dect_evlog_enabled())			\
+			__dect_evlog_##type(args);		\
+	} while (0)
+
+#endif /* _DECTMON_EVLOG_H */
@@ -0,0 +1,23 @@
+#ifndef _DECTMON_G711_H
+#define _DECTMON_G711_H
+
+#include <stdint.h>
+
+/*
+ * Block G.711 conversion
+ *
+ * Bit-exact with linear2alaw()/alaw2linear() and linear2ulaw()/ulaw2linear()
+ * from the reference implementation, but converting a whole buffer per call
+ * using lookup tables indexed by the full 16 bit sample, so the loops contain
+ * no branches. dect_g711_init() builds the tables and must be called before
+ * any of the conversion functions are used.
+ */
+
+extern void dect_g711_init(void);
+
+extern void dect_alaw_encode(uint8_t *dst, const int16_t *src, unsigned int n);
+extern void dect_alaw_decode(int16_t *dst, const uint8_t *src, unsigned int n);
+extern void dect_ulaw_encode(uint8_t *dst, const int16_t *src, unsigned int n);
+extern void dect_ulaw_decode(int16_t *dst, const uint8_t *src, unsigned int n);
+
+#endif /* _DECTMON_G711_H */
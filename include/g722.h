@@ -0,0 +1,37 @@
+#ifndef _DECTMON_G722_H
+#define _DECTMON_G722_H
+
+#include <stdint.h>
+
+/*
+ * G.722 64 kbit/s decoder
+ *
+ * Each octet carries a 6 bit lower and a 2 bit higher sub-band code word
+ * and decodes to two 16 bit samples at 16 kHz.
+ */
+
+struct dect_g722_band {
+	int		s;
+	int		sp;
+	int		sz;
+	int		r[3];
+	int		a[3];
+	int		ap[3];
+	int		p[3];
+	int		d[7];
+	int		b[7];
+	int		bp[7];
+	int		nb;
+	int		det;
+};
+
+struct dect_g722_state {
+	int			x[24];
+	struct dect_g722_band	band[2];
+};
+
+extern void dect_g722_init(struct dect_g722_state *s);
+extern void dect_g722_decode(struct dect_g722_state *s, int16_t *dst,
+			     const uint8_t *src, unsigned int len);
+
+#endif /* _DECTMON_G722_H */
@@ -0,0 +1,30 @@
+#ifndef _DECTMON_KEYSTORE_H
+#define _DECTMON_KEYSTORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Persistent IPEI to UAK key store
+ *
+ * All keys are loaded from $HOME/dectmon.keys into a hash table at startup.
+ * Updates are applied to the table immediately and appended to the file
+ * by a background thread, which also compacts the file once it contains
+ * too many superseded entries. The file format is one "IPEI|UAK" line per
+ * entry, later lines override earlier ones.
+ */
+
+#define DECT_KEYSTORE_FILE		"dectmon.keys"
+#define DECT_KEYSTORE_HASH_BITS		10
+#define DECT_KEYSTORE_HASH_SIZE		(1 << DECT_KEYSTORE_HASH_BITS)
+#define DECT_KEYSTORE_COMPACT_MIN	64
+
+struct dect_ipei;
+
+extern int dect_keystore_init(void);
+extern void dect_keystore_exit(void);
+extern bool dect_keystore_lookup(const struct dect_ipei *ipei, uint8_t *uak);
+extern void dect_keystore_update(const struct dect_ipei *ipei,
+				 const uint8_t *uak);
+
+#endif /* _DECTMON_KEYSTORE_H */
@@ -0,0 +1,23 @@
+#ifndef _DECTMON_LOG_H
+#define _DECTMON_LOG_H
+
+#include <stdio.h>
+
+/*
+ * Asynchronous log sink
+ *
+ * dectmon_log() formats messages into a bounded lock-free multi-producer
+ * queue, a sink thread writes them to the terminal and the logfile. When
+ * the queue is full messages are dropped and accounted for instead of
+ * blocking the caller.
+ */
+
+#define DECTMON_LOG_ENTRIES	2048
+#define DECTMON_LOG_MSG_SIZE	512
+#define DECTMON_LOG_ROTATE	4
+
+extern int dectmon_log_open(const char *name, unsigned long rotate_size);
+extern int dectmon_log_init(void);
+extern void dectmon_log_exit(void);
+
+#endif /* _DECTMON_LOG_H */
@@ -1,6 +1,19 @@
 #ifndef _NWK_H
 #define _NWK_H
 
+/* Protocol discriminators */
+enum dect_protocol_discriminators {
+	DECT_PD_LCE				= 0x0,
+	DECT_PD_CC				= 0x3,
+	DECT_PD_CISS				= 0x4,
+	DECT_PD_MM				= 0x5,
+	DECT_PD_CLMS				= 0x6,
+	DECT_PD_COMS				= 0x7,
+};
+
+#define DECT_PD_MASK				0x0f
+#define DECT_PD_MAX				DECT_PD_COMS
+
 /* LCE message types */
 enum dect_lce_msg_types {
 	DECT_LCE_PAGE_RESPONSE			= 0x71,
@@ -70,4 +83,6 @@ enum dect_mm_msg_types {
 	DECT_MM_TEMPORARY_IDENTITY_ASSIGN_REJ	= 0x5f,
 };
 
+extern const char * const nwk_msg_types[256];
+
 #endif /* _NWK_H */
@@ -1,11 +1,37 @@
 #ifndef _DECTMON_OPS_H
 #define _DECTMON_OPS_H
 
+#include <stdbool.h>
+#include <list.h>
+
 struct dect_ops;
+struct dect_handle;
+struct dect_fd;
+struct dect_loop;
+
+typedef void (*dect_fd_batch_t)(struct dect_handle *dh, struct dect_fd *dfd);
+
+struct dect_loop_work {
+	struct list_head	list;
+	void			(*func)(struct dect_loop_work *work);
+	bool			pending;
+};
+
 extern int dect_event_ops_init(struct dect_ops *ops);
 extern void dect_event_loop_stop(void);
 extern void dect_event_loop(void);
 extern void dect_event_ops_cleanup(void);
+extern void dect_event_fd_batch(struct dect_fd *dfd, dect_fd_batch_t batch);
+
+extern struct dect_loop *dect_loop_alloc(void);
+extern void dect_loop_free(struct dect_loop *loop);
+extern void dect_loop_set_current(struct dect_loop *loop);
+extern void dect_loop_lock(struct dect_loop *loop);
+extern void dect_loop_unlock(struct dect_loop *loop);
+extern void dect_loop_run(struct dect_loop *loop);
+extern void dect_loop_stop(struct dect_loop *loop);
+extern void dect_loop_queue_work(struct dect_loop *loop,
+				 struct dect_loop_work *work);
 extern void dect_dummy_ops_init(struct dect_ops *ops);
 
 #endif /* _DECTMON_OPS_H */
@@ -0,0 +1,88 @@
+#ifndef _DECTMON_RECORD_H
+#define _DECTMON_RECORD_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <utils.h>
+#include <audio.h>
+
+/*
+ * Call recording
+ *
+ * When a recording directory is given with --record, a recorder sink is
+ * attached to the audio handle of each call, which writes the decoded
+ * samples to one mono WAV file per direction, named
+ * <cluster>-<IPEI>-<time>-<fp|pp>.wav. No sound device is used. The
+ * sample rate of a file is determined by the codec of the first frame,
+ * frames of a different rate are converted. Samples are stored as 16 bit
+ * linear PCM or, with --record-format, G.711 A-law or u-law. With
+ * --record-silence=no, frames classified as silence are not written, so
+ * the recording only contains the talk spurts.
+ */
+
+enum dect_record_formats {
+	DECT_RECORD_PCM,
+	DECT_RECORD_ALAW,
+	DECT_RECORD_ULAW,
+};
+
+/*
+ * RIFF WAVE header
+ *
+ * The file starts with the RIFF chunk header and the WAVE form type,
+ * followed by the fmt chunk and the data chunk. Non-PCM formats use the
+ * extended fmt chunk including @cb_size and have a fact chunk containing
+ * the number of samples before the data chunk. All fields are little
+ * endian.
+ */
+struct dect_wav_chunk {
+	char		id[4];
+	uint32_t	size;
+} __packed;
+
+struct dect_wav_fmt {
+	uint16_t	format;
+	uint16_t	channels;
+	uint32_t	rate;
+	uint32_t	byte_rate;
+	uint16_t	block_align;
+	uint16_t	bits;
+	uint16_t	cb_size;
+} __packed;
+
+#define DECT_WAV_HEADER_MAX_SIZE	(sizeof(struct dect_wav_chunk) + 4 +	\
+					 sizeof(struct dect_wav_chunk) +	\
+					 sizeof(struct dect_wav_fmt) +		\
+					 sizeof(struct dect_wav_chunk) + 4 +	\
+					 sizeof(struct dect_wav_chunk))
+
+/**
+ * struct dect_record - call recording
+ *
+ * @sink:	audio sink
+ * @file:	WAV file per direction
+ * @rate:	sample rate per direction, zero until the first frame
+ * @prev:	last sample per direction for rate conversion
+ * @samples:	number of samples written per direction
+ */
+struct dect_record {
+	struct dect_audio_sink	sink;
+	FILE			*file[2];
+	unsigned int		rate[2];
+	int16_t			prev[2];
+	uint32_t		samples[2];
+};
+
+struct dect_pt;
+
+extern const char *dect_record_dir;
+extern enum dect_record_formats dect_record_format;
+extern bool dect_record_skip_silence;
+
+extern int dect_record_parse_format(const char *name);
+
+extern struct dect_audio_sink *dect_record_open(const char *cluster,
+						const struct dect_pt *pt);
+
+#endif /* _DECTMON_RECORD_H */
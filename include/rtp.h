@@ -0,0 +1,82 @@
+#ifndef _DECTMON_RTP_H
+#define _DECTMON_RTP_H
+
+#include <stdint.h>
+#include <utils.h>
+#include <audio.h>
+
+/*
+ * RTP call audio streaming
+ *
+ * When a destination is given with --stream, an RTP sink is attached to the
+ * audio handle of each call, which sends the decoded samples of both
+ * directions as L16 (network byte order, mono) to udp:HOST:PORT or to the
+ * datagram unix socket unix:PATH. Each call uses its own socket and each
+ * direction its own SSRC. The payload type is DECT_RTP_PT_L16_8K for 8 kHz
+ * and DECT_RTP_PT_L16_16K for 16 kHz audio.
+ *
+ * One packet is sent per TDMA frame. The RTP sequence number and timestamp
+ * are derived from the frame sequence number. Frames lost on the air are
+ * concealed by the audio engine and sent like received frames, only gaps
+ * too large to conceal show up in the sequence numbers. Packets are batched
+ * per worker run and sent with non-blocking sockets, packets which don't
+ * fit in the socket buffer are dropped.
+ */
+
+#define DECT_RTP_VERSION	2
+#define DECT_RTP_PT_L16_8K	96
+#define DECT_RTP_PT_L16_16K	97
+#define DECT_RTP_BATCH		16
+
+/**
+ * struct dect_rtp_hdr - RTP fixed header
+ *
+ * All fields are big endian.
+ */
+struct dect_rtp_hdr {
+	uint8_t		vpxcc;
+	uint8_t		mpt;
+	uint16_t	seq;
+	uint32_t	timestamp;
+	uint32_t	ssrc;
+} __packed;
+
+#define DECT_RTP_MARKER		0x80
+
+struct dect_rtp_packet {
+	struct dect_rtp_hdr	hdr;
+	int16_t			data[DECT_AUDIO_MAX_FRAME_SAMPLES];
+} __packed;
+
+/**
+ * struct dect_rtp_stream - RTP stream of a call
+ *
+ * @sink:	audio sink
+ * @fd:		connected socket
+ * @ssrc:	synchronization source per direction
+ * @samples:	samples per packet per direction, the first packet and
+ *		packets after a rate change carry the marker bit
+ * @npkts:	number of pending packets in @pkts
+ * @sent:	number of packets sent
+ * @dropped:	number of packets dropped
+ * @pkts:	pending packets
+ * @len:	length of the pending packets
+ */
+struct dect_rtp_stream {
+	struct dect_audio_sink	sink;
+	int			fd;
+	uint32_t		ssrc[2];
+	unsigned int		samples[2];
+	unsigned int		npkts;
+	unsigned long		sent;
+	unsigned long		dropped;
+	struct dect_rtp_packet	pkts[DECT_RTP_BATCH];
+	unsigned int		len[DECT_RTP_BATCH];
+};
+
+extern const char *dect_rtp_dest;
+
+extern int dect_rtp_init(const char *dest);
+extern struct dect_audio_sink *dect_rtp_open(void);
+
+#endif /* _DECTMON_RTP_H */
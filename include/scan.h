@@ -0,0 +1,57 @@
+#ifndef _DECTMON_SCAN_H
+#define _DECTMON_SCAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <list.h>
+#include <ops.h>
+
+#define DECT_LOCK_TIMEOUT		15
+#define DECT_SCAN_MAX_FAILURES		3
+#define DECT_SCAN_BLACKLIST_TIME	300
+
+/**
+ * enum dect_scan_states - receiver scan states
+ *
+ * @DECT_SCAN_IDLE:	scanning, no FP assigned
+ * @DECT_SCAN_LOCKING:	FP assigned, waiting for lock
+ * @DECT_SCAN_LOCKED:	locked to assigned FP
+ */
+enum dect_scan_states {
+	DECT_SCAN_IDLE,
+	DECT_SCAN_LOCKING,
+	DECT_SCAN_LOCKED,
+};
+
+struct dect_scan_fp;
+
+/**
+ * struct dect_scan_receiver - per receiver scan state
+ *
+ * @list:	idle receiver list node
+ * @state:	scan state
+ * @fp:		assigned FP
+ * @start:	time of FP assignment
+ * @work:	deferred FP assignment from other receivers
+ */
+struct dect_scan_receiver {
+	struct list_head		list;
+	enum dect_scan_states		state;
+	struct dect_scan_fp		*fp;
+	uint64_t			start;
+	struct dect_loop_work		work;
+};
+
+struct dect_handle_priv;
+struct dect_llme_ops_;
+
+extern bool scan;
+extern struct dect_llme_ops_ dect_scan_llme_ops;
+
+extern int dect_scan_open(struct dect_handle_priv *priv);
+extern void dect_scan_close(struct dect_handle_priv *priv);
+extern void dect_scan_start(struct dect_handle_priv *priv);
+extern void dect_scan_stop(struct dect_handle_priv *priv);
+extern void dect_scan_show(void);
+
+#endif /* _DECTMON_SCAN_H */
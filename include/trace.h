@@ -0,0 +1,49 @@
+#ifndef _DECTMON_TRACE_H
+#define _DECTMON_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * enum dect_trace_stages - receive path stages
+ *
+ * @DECT_TRACE_MAC:	MAC tail parsed
+ * @DECT_TRACE_DLC:	DLC SDU reassembled
+ * @DECT_TRACE_NWK:	NWK message parsed
+ * @DECT_TRACE_AUDIO:	B-field queued for audio processing
+ * @DECT_TRACE_FRAME:	frame processing complete
+ *
+ * Each stage records the latency relative to dect_raw_rcv() entry of the
+ * frame currently being processed.
+ */
+enum dect_trace_stages {
+	DECT_TRACE_MAC,
+	DECT_TRACE_DLC,
+	DECT_TRACE_NWK,
+	DECT_TRACE_AUDIO,
+	DECT_TRACE_FRAME,
+	__DECT_TRACE_MAX
+};
+#define DECT_TRACE_MAX		(__DECT_TRACE_MAX - 1)
+
+extern bool dect_trace_enabled;
+
+extern void __dect_trace_frame_start(void);
+extern void __dect_trace_stage(enum dect_trace_stages stage);
+
+static inline void dect_trace_frame_start(void)
+{
+	if (__builtin_expect(dect_trace_enabled, 0))
+		__dect_trace_frame_start();
+}
+
+static inline void dect_trace_stage(enum dect_trace_stages stage)
+{
+	if (__builtin_expect(dect_trace_enabled, 0))
+		__dect_trace_stage(stage);
+}
+
+extern void dect_trace_show(void);
+extern void dect_trace_reset(void);
+
+#endif /* _DECTMON_TRACE_H */
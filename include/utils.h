@@ -42,13 +42,7 @@
 
 static inline unsigned int fls(uint64_t v)
 {
-	unsigned int len = 0;
-
-	while (v) {
-		v >>= 1;
-		len++;
-	}
-	return len;
+	return v ? 64 - __builtin_clzll(v) : 0;
 }
 
 #define ptrlist_init(head)				\
@@ -0,0 +1,276 @@
+/*
+ * dectmon G.721 block decoder
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Derived from the Sun Microsystems CCITT ADPCM reference implementation
+ * in ccitt-adpcm/, which is provided for unrestricted use, see the notice
+ * in ccitt-adpcm/g72x.c.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <utils.h>
+#include <adpcm.h>
+
+static const short g721_dqlntab[16] = {
+	-2048, 4, 135, 213, 273, 323, 373, 425,
+	425, 373, 323, 273, 213, 135, 4, -2048,
+};
+
+/* Log of scale factor multiplier, pre-scaled by 32 */
+static const int g721_witab[16] = {
+	-12 * 32, 18 * 32, 41 * 32, 64 * 32,
+	112 * 32, 198 * 32, 355 * 32, 1122 * 32,
+	1122 * 32, 355 * 32, 198 * 32, 112 * 32,
+	64 * 32, 41 * 32, 18 * 32, -12 * 32,
+};
+
+static const short g721_fitab[16] = {
+	0, 0, 0, 0x200, 0x200, 0x200, 0x600, 0xE00,
+	0xE00, 0x600, 0x200, 0x200, 0x200, 0, 0, 0,
+};
+
+/* quan(val, power2, 15) for non-negative values */
+static inline int g72x_quan(int val)
+{
+	return min(fls(val), 15U);
+}
+
+/*
+ * Multiply the predictor coefficient @an with the floating point value
+ * @srn. Equivalent to fmult() without data dependent branches.
+ */
+static inline int g72x_fmult(int an, int srn)
+{
+	int anmag, anexp, anmant, wanexp, wanmant, retval, lshift, rshift, sign;
+
+	anmag  = an > 0 ? an : (-an) & 0x1FFF;
+	anexp  = g72x_quan(anmag);
+	anmant = ((anmag << 6) >> anexp) | ((anmag == 0) << 5);
+	wanexp = anexp - 6 + ((srn >> 6) & 0xF) - 13;
+
+	wanmant = (anmant * (srn & 077) + 0x30) >> 4;
+	lshift  = wanexp > 0 ? wanexp : 0;
+	rshift  = wanexp < 0 ? -wanexp : 0;
+	retval  = ((wanmant << lshift) >> rshift) & 0x7FFF;
+
+	sign = -((an ^ srn) < 0);
+	return (retval ^ sign) - sign;
+}
+
+static inline int g72x_step_size(const struct g72x_state *s)
+{
+	int y, dif, al;
+
+	if (s->ap >= 256)
+		return s->yu;
+
+	y   = s->yl >> 6;
+	dif = s->yu - y;
+	al  = s->ap >> 2;
+	if (dif > 0)
+		y += (dif * al) >> 6;
+	else if (dif < 0)
+		y += (dif * al + 0x3F) >> 6;
+	return y;
+}
+
+static inline int g72x_reconstruct(int sign, int dqln, int y)
+{
+	short dql, dex, dqt, dq;
+
+	dql = dqln + (y >> 2);
+	if (dql < 0)
+		return sign ? -0x8000 : 0;
+
+	dex = (dql >> 7) & 15;
+	dqt = 128 + (dql & 127);
+	dq  = (dqt << 7) >> (14 - dex);
+	return sign ? dq - 0x8000 : dq;
+}
+
+/* Convert to 4 bit exponent, 6 bit mantissa floating point */
+static inline short g72x_float(int mag)
+{
+	int exp = g72x_quan(mag);
+
+	return (exp << 6) + ((mag << 6) >> exp);
+}
+
+/* update() for code size 4 */
+static inline void g721_update(struct g72x_state *s, int y, int wi, int fi,
+			       int dq, int sr, int dqsez)
+{
+	short mag, a2p = 0, a1ul, pks1, fa1, ylint, thr2, dqthr, ylfrac, thr1;
+	short pk0;
+	char tr;
+	int cnt;
+
+	pk0 = dqsez < 0 ? 1 : 0;
+	mag = dq & 0x7FFF;
+
+	/* TRANS */
+	ylint  = s->yl >> 15;
+	ylfrac = (s->yl >> 10) & 0x1F;
+	thr1   = (32 + ylfrac) << ylint;
+	thr2   = ylint > 9 ? 31 << 10 : thr1;
+	dqthr  = (thr2 + (thr2 >> 1)) >> 1;
+	tr     = s->td != 0 && mag > dqthr;
+
+	/* FUNCTW & FILTD & DELAY, LIMB */
+	s->yu = y + ((wi - y) >> 5);
+	if (s->yu < 544)
+		s->yu = 544;
+	else if (s->yu > 5120)
+		s->yu = 5120;
+
+	/* FILTE & DELAY */
+	s->yl += s->yu + ((-s->yl) >> 6);
+
+	if (tr) {
+		s->a[0] = s->a[1] = 0;
+		for (cnt = 0; cnt < 6; cnt++)
+			s->b[cnt] = 0;
+	} else {
+		pks1 = pk0 ^ s->pk[0];
+
+		/* UPA2 */
+		a2p = s->a[1] - (s->a[1] >> 7);
+		if (dqsez != 0) {
+			fa1 = pks1 ? s->a[0] : -s->a[0];
+			if (fa1 < -8191)
+				a2p -= 0x100;
+			else if (fa1 > 8191)
+				a2p += 0xFF;
+			else
+				a2p += fa1 >> 5;
+
+			/* LIMC */
+			if (pk0 ^ s->pk[1]) {
+				if (a2p <= -12160)
+					a2p = -12288;
+				else if (a2p >= 12416)
+					a2p = 12288;
+				else
+					a2p -= 0x80;
+			} else if (a2p <= -12416)
+				a2p = -12288;
+			else if (a2p >= 12160)
+				a2p = 12288;
+			else
+				a2p += 0x80;
+		}
+		s->a[1] = a2p;
+
+		/* UPA1 */
+		s->a[0] -= s->a[0] >> 8;
+		if (dqsez != 0)
+			s->a[0] += pks1 == 0 ? 192 : -192;
+
+		/* LIMD */
+		a1ul = 15360 - a2p;
+		if (s->a[0] < -a1ul)
+			s->a[0] = -a1ul;
+		else if (s->a[0] > a1ul)
+			s->a[0] = a1ul;
+
+		/* UPB */
+		for (cnt = 0; cnt < 6; cnt++) {
+			s->b[cnt] -= s->b[cnt] >> 8;
+			if (mag)
+				s->b[cnt] += (dq ^ s->dq[cnt]) >= 0 ? 128 : -128;
+		}
+	}
+
+	for (cnt = 5; cnt > 0; cnt--)
+		s->dq[cnt] = s->dq[cnt - 1];
+
+	/* FLOAT A */
+	if (mag == 0)
+		s->dq[0] = dq >= 0 ? 0x20 : (short)0xFC20;
+	else
+		s->dq[0] = g72x_float(mag) - (dq >= 0 ? 0 : 0x400);
+
+	/* FLOAT B */
+	s->sr[1] = s->sr[0];
+	if (sr == 0)
+		s->sr[0] = 0x20;
+	else if (sr > 0)
+		s->sr[0] = g72x_float(sr);
+	else if (sr > -32768)
+		s->sr[0] = g72x_float(-sr) - 0x400;
+	else
+		s->sr[0] = (short)0xFC20;
+
+	/* DELAY A */
+	s->pk[1] = s->pk[0];
+	s->pk[0] = pk0;
+
+	/* TONE */
+	if (tr)
+		s->td = 0;
+	else
+		s->td = a2p < -11776;
+
+	/* FILTA, FILTB */
+	s->dms += (fi - s->dms) >> 5;
+	s->dml += ((fi << 2) - s->dml) >> 7;
+
+	/* SUBTC */
+	if (tr)
+		s->ap = 256;
+	else if (y < 1536 || s->td == 1 ||
+		 abs((s->dms << 2) - s->dml) >= (s->dml >> 3))
+		s->ap += (0x200 - s->ap) >> 4;
+	else
+		s->ap += (-s->ap) >> 4;
+}
+
+static inline int16_t g721_decode_sample(struct g72x_state *s, unsigned int i)
+{
+	short sezi, sei, sez, se, y, sr, dq, dqsez;
+	int cnt;
+
+	sezi = 0;
+	for (cnt = 0; cnt < 6; cnt++)
+		sezi += g72x_fmult(s->b[cnt] >> 2, s->dq[cnt]);
+	sez = sezi >> 1;
+	sei = sezi + g72x_fmult(s->a[1] >> 2, s->sr[1]) +
+		     g72x_fmult(s->a[0] >> 2, s->sr[0]);
+	se  = sei >> 1;
+
+	y  = g72x_step_size(s);
+	dq = g72x_reconstruct(i & 0x08, g721_dqlntab[i], y);
+	sr = dq < 0 ? se - (dq & 0x3FFF) : se + dq;
+	dqsez = sr - se + sez;
+
+	g721_update(s, y, g721_witab[i], g721_fitab[i], dq, sr, dqsez);
+	return sr << 2;
+}
+
+/**
+ * dect_g721_decode - decode a buffer of G.721 code words
+ *
+ * @state:	decoder state
+ * @dst:	output buffer for 2 * @len linear samples
+ * @src:	code words, two per byte, most significant nibble first
+ * @len:	number of bytes in @src
+ */
+void dect_g721_decode(struct g72x_state *state, int16_t *dst,
+		      const uint8_t *src, unsigned int len)
+{
+	struct g72x_state s = *state;
+	unsigned int i;
+
+	for (i = 0; i < len; i++) {
+		*dst++ = g721_decode_sample(&s, src[i] >> 4);
+		*dst++ = g721_decode_sample(&s, src[i] & 0x0f);
+	}
+	*state = s;
+}
@@ -1,121 +1,665 @@
+/*
+ * dectmon audio engine
+ *
+ * Copyright (c) 2010 Patrick McHardy <kaber@trash.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include <SDL/SDL.h>
 #include <SDL/SDL_audio.h>
 
 #include <dectmon.h>
 #include <audio.h>
+#include <g711.h>
 #include <utils.h>
+#include <trace.h>
 
-void dect_audio_queue(struct dect_audio_handle *ah, unsigned int queue,
-		      struct dect_msg_buf *mb)
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+static LIST_HEAD(pool_runq);
+static pthread_t pool_threads[DECT_AUDIO_WORKERS];
+static unsigned int pool_nthreads;
+static bool pool_stop;
+
+/*
+ * Replace a lost frame by the last received one, attenuated by 6dB for
+ * every consecutive lost frame.
+ */
+static void dect_audio_conceal(int16_t *dst, const int16_t *last,
+			       unsigned int n, unsigned int lost)
+{
+	int div = 1 << min(lost, 15U);
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = last[i] / div;
+}
+
+/**
+ * dect_audio_resample - convert one frame between 8 and 16 kHz
+ *
+ * @dst:	destination buffer for @dn samples
+ * @dn:		number of destination samples
+ * @src:	source samples
+ * @sn:		number of source samples, equal to, twice or half of @dn
+ * @prev:	last source sample of the previous frame, updated
+ *
+ * Upsampling interpolates linearly, downsampling averages sample pairs.
+ * Returns the number of samples written to @dst.
+ */
+unsigned int dect_audio_resample(int16_t *dst, unsigned int dn,
+				 const int16_t *src, unsigned int sn,
+				 int16_t *prev)
+{
+	unsigned int i;
+
+	if (dn == 2 * sn) {
+		for (i = 0; i < sn; i++) {
+			dst[2 * i]     = (*prev + src[i]) / 2;
+			dst[2 * i + 1] = src[i];
+			*prev = src[i];
+		}
+	} else if (2 * dn == sn) {
+		for (i = 0; i < dn; i++)
+			dst[i] = (src[2 * i] + src[2 * i + 1]) / 2;
+		*prev = src[sn - 1];
+	} else {
+		dn = min(dn, sn);
+		memcpy(dst, src, dn * sizeof(int16_t));
+		*prev = src[sn - 1];
+	}
+	return dn;
+}
+
+/*
+ * Playback mixer
+ *
+ * Every call played back has a mixer sink with a jitter buffer per
+ * direction. The workers store decoded frames, converted to the mixer rate
+ * of 16 kHz, in the slot of their sequence number, the SDL audio callback
+ * plays them out in sequence and sums up all streams. The mixer list is
+ * protected by the SDL audio lock.
+ *
+ * Playout starts once @target frames are buffered. When the playout point
+ * catches up with the newest frame, it is held back and concealment frames
+ * are played until the buffer is refilled, the target is raised on every
+ * underrun and slowly lowered again while playout is stable. When more than
+ * twice the target is buffered, playout skips ahead to bound the latency.
+ */
+
+#define DECT_JB_SLOTS		64
+#define DECT_JB_TARGET_MIN	8
+#define DECT_JB_TARGET_MAX	24
+#define DECT_JB_TARGET_DECAY	500
+#define DECT_JB_FRAME_SAMPLES	(DECT_AUDIO_MIXER_RATE / DECT_AUDIO_FRAME_RATE)
+
+struct dect_jb_slot {
+	uint32_t		tag;
+	int16_t			samples[DECT_JB_FRAME_SAMPLES];
+};
+
+/**
+ * struct dect_jitter_buffer - playback jitter buffer
+ *
+ * @head:	sequence number of the newest frame + 1, zero if empty (writer)
+ * @prev:	last sample of the previous frame for resampling (writer)
+ * @started:	@seq is valid
+ * @buffering:	playout is held back until @target frames are buffered
+ * @seq:	sequence number of the next frame to play
+ * @target:	target number of buffered frames
+ * @stable:	number of frames played since the last target change
+ * @lost:	number of consecutive concealed frames
+ * @off:	playout offset into @cur
+ * @cur:	frame being played
+ * @last:	last frame received in time
+ * @underruns:	number of underruns
+ * @missing:	number of frames missing at playout time
+ * @skipped:	number of frames skipped to reduce latency
+ * @slots:	frame slots indexed by sequence number
+ *
+ * A slot's tag is the sequence number of its frame + 1 or zero while the
+ * frame is being written.
+ */
+struct dect_jitter_buffer {
+	uint32_t		head __aligned(64);
+	int16_t			prev;
+
+	bool			started __aligned(64);
+	bool			buffering;
+	uint32_t		seq;
+	unsigned int		target;
+	unsigned int		stable;
+	unsigned int		lost;
+	unsigned int		off;
+	int16_t			cur[DECT_JB_FRAME_SAMPLES];
+	int16_t			last[DECT_JB_FRAME_SAMPLES];
+	unsigned long		underruns;
+	unsigned long		missing;
+	unsigned long		skipped;
+
+	struct dect_jb_slot	slots[DECT_JB_SLOTS];
+};
+
+struct dect_audio_mixer {
+	struct dect_audio_sink		sink;
+	struct list_head		list;
+	struct dect_jitter_buffer	jb[2];
+};
+
+static LIST_HEAD(mixer_list);
+static bool mixer_enabled;
+
+static void dect_jb_init(struct dect_jitter_buffer *jb)
+{
+	jb->target = DECT_JB_TARGET_MIN;
+	jb->off    = DECT_JB_FRAME_SAMPLES;
+}
+
+static void dect_jb_write(struct dect_jitter_buffer *jb, uint32_t seq,
+			  const int16_t *samples, unsigned int n)
+{
+	struct dect_jb_slot *slot = &jb->slots[seq % DECT_JB_SLOTS];
+
+	__atomic_store_n(&slot->tag, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	dect_audio_resample(slot->samples, DECT_JB_FRAME_SAMPLES,
+			    samples, n, &jb->prev);
+	__atomic_store_n(&slot->tag, seq + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&jb->head, seq + 1, __ATOMIC_RELEASE);
+}
+
+static bool dect_jb_read_slot(struct dect_jitter_buffer *jb, uint32_t seq)
+{
+	struct dect_jb_slot *slot = &jb->slots[seq % DECT_JB_SLOTS];
+
+	if (__atomic_load_n(&slot->tag, __ATOMIC_ACQUIRE) != seq + 1)
+		return false;
+	memcpy(jb->cur, slot->samples, sizeof(jb->cur));
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&slot->tag, __ATOMIC_RELAXED) == seq + 1;
+}
+
+static void dect_jb_conceal(struct dect_jitter_buffer *jb)
+{
+	dect_audio_conceal(jb->cur, jb->last, DECT_JB_FRAME_SAMPLES, ++jb->lost);
+}
+
+/* Load the next frame to play into jb->cur */
+static void dect_jb_next(struct dect_jitter_buffer *jb)
+{
+	uint32_t head, newest;
+	int buffered;
+
+	head = __atomic_load_n(&jb->head, __ATOMIC_ACQUIRE);
+	if (head == 0) {
+		memset(jb->cur, 0, sizeof(jb->cur));
+		return;
+	}
+	newest = head - 1;
+
+	if (!jb->started) {
+		jb->seq       = newest;
+		jb->started   = true;
+		jb->buffering = true;
+	}
+
+	buffered = dect_audio_seq_diff(newest, jb->seq) + 1;
+	if (buffered < -DECT_JB_SLOTS) {
+		/* stream restarted at an earlier sequence number */
+		jb->seq       = newest;
+		jb->buffering = true;
+		buffered      = 1;
+	}
+
+	if (jb->buffering) {
+		if (buffered < (int)jb->target) {
+			dect_jb_conceal(jb);
+			return;
+		}
+		jb->buffering = false;
+	} else if (buffered <= 0) {
+		jb->underruns++;
+		jb->buffering = true;
+		jb->target += 2;
+		if (jb->target > DECT_JB_TARGET_MAX)
+			jb->target = DECT_JB_TARGET_MAX;
+		jb->stable = 0;
+		dect_jb_conceal(jb);
+		return;
+	} else if (buffered > 2 * (int)jb->target) {
+		jb->skipped += buffered - jb->target;
+		jb->seq = dect_audio_seq_add(newest, 1 - jb->target);
+	}
+
+	if (dect_jb_read_slot(jb, jb->seq)) {
+		memcpy(jb->last, jb->cur, sizeof(jb->last));
+		jb->lost = 0;
+	} else {
+		jb->missing++;
+		dect_jb_conceal(jb);
+	}
+	jb->seq = dect_audio_seq_add(jb->seq, 1);
+
+	if (++jb->stable == DECT_JB_TARGET_DECAY) {
+		if (jb->target > DECT_JB_TARGET_MIN)
+			jb->target--;
+		jb->stable = 0;
+	}
+}
+
+static void dect_jb_read(struct dect_jitter_buffer *jb, int16_t *dst,
+			 unsigned int n)
+{
+	unsigned int copy;
+
+	while (n > 0) {
+		if (jb->off == DECT_JB_FRAME_SAMPLES) {
+			dect_jb_next(jb);
+			jb->off = 0;
+		}
+
+		copy = min(n, DECT_JB_FRAME_SAMPLES - jb->off);
+		memcpy(dst, jb->cur + jb->off, copy * sizeof(int16_t));
+		jb->off += copy;
+		dst += copy;
+		n -= copy;
+	}
+}
+
+static void dect_audio_mix(void *data, uint8_t *stream, int len)
 {
+	struct dect_audio_mixer *mx;
+	unsigned int n = len / sizeof(int16_t), i;
+	int16_t buf[n];
+
+	list_for_each_entry(mx, &mixer_list, list) {
+		for (i = 0; i < array_size(mx->jb); i++) {
+			dect_jb_read(&mx->jb[i], buf, n);
+			SDL_MixAudio(stream, (uint8_t *)buf, len,
+				     SDL_MIX_MAXVOLUME);
+		}
+	}
+}
+
+static void dect_audio_mixer_write(struct dect_audio_sink *sink,
+				   unsigned int dir, uint32_t seq,
+				   const int16_t *samples, unsigned int n,
+				   bool voice)
+{
+	struct dect_audio_mixer *mx;
+
+	mx = container_of(sink, struct dect_audio_mixer, sink);
+	dect_jb_write(&mx->jb[dir], seq, samples, n);
+}
+
+static void dect_audio_mixer_close(struct dect_audio_sink *sink)
+{
+	struct dect_audio_mixer *mx;
+
+	mx = container_of(sink, struct dect_audio_mixer, sink);
 	SDL_LockAudio();
-	ptrlist_add_tail(mb, &ah->queue[queue]);
+	list_del(&mx->list);
 	SDL_UnlockAudio();
+
+	dectmon_log("audio playback: underruns %lu/%lu missing %lu/%lu "
+		    "skipped %lu/%lu\n",
+		    mx->jb[0].underruns, mx->jb[1].underruns,
+		    mx->jb[0].missing, mx->jb[1].missing,
+		    mx->jb[0].skipped, mx->jb[1].skipped);
+	free(mx);
 }
 
-static void dect_decode_g721(struct g72x_state *codec,
-			     int16_t *dst, const uint8_t *src,
-			     unsigned int len)
+static const struct dect_audio_sink_ops dect_audio_mixer_ops = {
+	.write		= dect_audio_mixer_write,
+	.close		= dect_audio_mixer_close,
+};
+
+struct dect_audio_sink *dect_audio_mixer_open(void)
 {
-	unsigned int i;
+	struct dect_audio_mixer *mx;
+
+	if (!mixer_enabled)
+		return NULL;
+
+	mx = calloc(1, sizeof(*mx));
+	if (mx == NULL)
+		return NULL;
+	mx->sink.ops = &dect_audio_mixer_ops;
+	dect_jb_init(&mx->jb[0]);
+	dect_jb_init(&mx->jb[1]);
 
-	for (i = 0; i < len * 2; i += 2) {
-		dst[i + 0] = g721_decoder(src[i / 2] >> 4,
-					  AUDIO_ENCODING_LINEAR, codec);
-		dst[i + 1] = g721_decoder(src[i / 2] & 0x0f,
-					  AUDIO_ENCODING_LINEAR, codec);
-	}
-}
-
-static void dect_audio_dequeue(void *data, uint8_t *stream, int len)
-{
-	struct dect_audio_handle *ah = data;
-	struct dect_msg_buf *mb;
-	int16_t buf[len], *dptr;
-	unsigned int i, copy, n;
-
-	len /= 4;
-	for (i = 0; i < array_size(ah->queue); i++) {
-		dptr = buf;
-		n = len;
-
-		while (1) {
-			if (ah->queue[i] == NULL) {
-				dectmon_log("audio underrun queue %u, missing %u bytes\n",
-					    i, n * 4);
-				memset(dptr, 0, n * 4);
-				break;
-			}
-
-			mb = ah->queue[i];
-			copy = mb->len;
-			if (copy > n)
-				copy = n;
-
-			dect_decode_g721(&ah->codec[i], dptr, mb->data, copy);
-			dect_mbuf_pull(mb, copy);
-			if (mb->len == 0) {
-				ah->queue[i] = mb->next;
-				free(mb);
-			}
-
-			n -= copy;
-			if (n == 0)
-				break;
-			dptr += 2 * copy;
+	SDL_LockAudio();
+	list_add_tail(&mx->list, &mixer_list);
+	SDL_UnlockAudio();
+	return &mx->sink;
+}
+
+/*
+ * Worker pool
+ */
+
+/* Must be called with pool_lock held */
+static void dect_audio_schedule(struct dect_audio_handle *ah)
+{
+	if (ah->queued)
+		return;
+	__atomic_store_n(&ah->queued, true, __ATOMIC_RELAXED);
+	if (!ah->running) {
+		list_add_tail(&ah->list, &pool_runq);
+		pthread_cond_signal(&pool_cond);
+	}
+}
+
+/*
+ * Energy based voice activity detection. The noise floor follows the level
+ * immediately downwards and slowly upwards, so it tracks the background
+ * noise in speech pauses without adapting to speech.
+ */
+static bool dect_audio_vad(struct dect_audio_vad *vad, const int16_t *samples,
+			   unsigned int n)
+{
+	unsigned int level, i;
+	uint32_t sum = 0;
+
+	for (i = 0; i < n; i++)
+		sum += abs(samples[i]);
+	level = sum / n;
+
+	if (level < vad->noise)
+		vad->noise = level;
+	else
+		vad->noise += (level - vad->noise + 127) / 128;
+
+	vad->frames++;
+	if (level > 2 * vad->noise && level > DECT_VAD_MIN_LEVEL)
+		vad->hangover = DECT_VAD_HANGOVER;
+	else if (vad->hangover > 0)
+		vad->hangover--;
+	else
+		return false;
+
+	vad->active++;
+	return true;
+}
+
+static void dect_audio_deliver(struct dect_audio_handle *ah, unsigned int dir,
+			       uint32_t seq, const int16_t *samples,
+			       unsigned int n)
+{
+	struct dect_audio_sink *sink;
+	bool voice;
+
+	voice = dect_audio_vad(&ah->vad[dir], samples, n);
+	list_for_each_entry(sink, &ah->sinks, list)
+		sink->ops->write(sink, dir, seq, samples, n, voice);
+}
+
+static void dect_audio_decode(struct dect_audio_handle *ah, unsigned int dir,
+			      const struct dect_audio_frame *frame)
+{
+	const struct dect_codec *codec = frame->codec;
+	struct dect_audio_plc *plc = &ah->plc[dir];
+	int16_t samples[DECT_AUDIO_MAX_FRAME_SAMPLES];
+	int gap;
+
+	if (ah->codec[dir] != codec) {
+		codec->init(&ah->state[dir]);
+		ah->codec[dir] = codec;
+		plc->valid = false;
+	}
+
+	if (plc->valid) {
+		gap = dect_audio_seq_diff(frame->seq, plc->next);
+		if (gap < 0 && gap >= -DECT_AUDIO_MAX_GAP) {
+			plc->late++;
+			return;
+		}
+
+		for (; gap > 0 && gap <= DECT_AUDIO_MAX_GAP; gap--) {
+			dect_audio_conceal(samples, plc->last, plc->samples,
+					   ++plc->lost);
+			dect_audio_deliver(ah, dir, plc->next, samples,
+					   plc->samples);
+			plc->next = dect_audio_seq_add(plc->next, 1);
+			plc->concealed++;
 		}
-		SDL_MixAudio(stream, (uint8_t *)buf, 4 * len, SDL_MIX_MAXVOLUME);
 	}
+
+	codec->decode(&ah->state[dir], samples, frame->data, codec->frame_size);
+	memcpy(plc->last, samples, codec->frame_samples * sizeof(int16_t));
+	plc->samples = codec->frame_samples;
+	plc->lost    = 0;
+	plc->next    = dect_audio_seq_add(frame->seq, 1);
+	plc->valid   = true;
+
+	dect_audio_deliver(ah, dir, frame->seq, samples, codec->frame_samples);
+}
+
+static void dect_audio_process(struct dect_audio_handle *ah)
+{
+	struct dect_audio_sink *sink;
+	struct dect_audio_ring *ring;
+	unsigned int i, head, tail;
+
+	for (i = 0; i < array_size(ah->ring); i++) {
+		ring = &ah->ring[i];
+		head = ring->head;
+		tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+		for (; head != tail; head++) {
+			dect_audio_decode(ah, i,
+					  &ring->frames[head % DECT_AUDIO_RING_SIZE]);
+			__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+		}
+	}
+
+	list_for_each_entry(sink, &ah->sinks, list) {
+		if (sink->ops->flush != NULL)
+			sink->ops->flush(sink);
+	}
+}
+
+static void dect_audio_release(struct dect_audio_handle *ah)
+{
+	const struct dect_audio_vad *vad = ah->vad;
+	struct dect_audio_sink *sink, *next;
+
+	dectmon_log("audio: talk time %lu.%02lus/%lu.%02lus "
+		    "of %lu.%02lus/%lu.%02lus\n",
+		    vad[0].active / 100, vad[0].active % 100,
+		    vad[1].active / 100, vad[1].active % 100,
+		    vad[0].frames / 100, vad[0].frames % 100,
+		    vad[1].frames / 100, vad[1].frames % 100);
+	if (ah->ring[0].overruns || ah->ring[1].overruns)
+		dectmon_log("audio: %lu/%lu frames dropped on ring overrun\n",
+			    ah->ring[0].overruns, ah->ring[1].overruns);
+	if (ah->plc[0].concealed || ah->plc[1].concealed ||
+	    ah->plc[0].late || ah->plc[1].late)
+		dectmon_log("audio: %lu/%lu frames concealed, %lu/%lu late\n",
+			    ah->plc[0].concealed, ah->plc[1].concealed,
+			    ah->plc[0].late, ah->plc[1].late);
+
+	list_for_each_entry_safe(sink, next, &ah->sinks, list) {
+		list_del(&sink->list);
+		sink->ops->close(sink);
+	}
+	free(ah);
+}
+
+static void *dect_audio_worker(void *arg)
+{
+	struct dect_audio_handle *ah;
+
+	pthread_mutex_lock(&pool_lock);
+	for (;;) {
+		while (list_empty(&pool_runq) && !pool_stop)
+			pthread_cond_wait(&pool_cond, &pool_lock);
+		if (list_empty(&pool_runq))
+			break;
+
+		ah = list_first_entry(&pool_runq, struct dect_audio_handle, list);
+		list_del(&ah->list);
+		__atomic_store_n(&ah->queued, false, __ATOMIC_RELAXED);
+		ah->running = true;
+		pthread_mutex_unlock(&pool_lock);
+
+		/* Pairs with the barrier in dect_audio_queue() */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		dect_audio_process(ah);
+
+		pthread_mutex_lock(&pool_lock);
+		ah->running = false;
+		if (ah->queued)
+			list_add_tail(&ah->list, &pool_runq);
+		else if (ah->closed) {
+			pthread_mutex_unlock(&pool_lock);
+			dect_audio_release(ah);
+			pthread_mutex_lock(&pool_lock);
+		}
+	}
+	pthread_mutex_unlock(&pool_lock);
+	return NULL;
+}
+
+/*
+ * Called by the receiving cluster thread. Frames arriving while the ring
+ * is full are dropped.
+ */
+void dect_audio_queue(struct dect_audio_handle *ah, unsigned int queue,
+		      uint32_t seq, const struct dect_codec *codec,
+		      const uint8_t *data)
+{
+	struct dect_audio_ring *ring = &ah->ring[queue];
+	struct dect_audio_frame *frame;
+	unsigned int tail, head;
+
+	tail = ring->tail;
+	head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	if (tail - head == DECT_AUDIO_RING_SIZE) {
+		ring->overruns++;
+		return;
+	}
+
+	frame = &ring->frames[tail % DECT_AUDIO_RING_SIZE];
+	frame->seq   = seq;
+	frame->codec = codec;
+	memcpy(frame->data, data, codec->frame_size);
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+	/*
+	 * A handle on the run queue picks up the new frame once a worker
+	 * processes it, so the pool lock is only taken to schedule idle
+	 * handles. The barrier orders the tail update before the check
+	 * against the worker clearing @queued before reading the tail.
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (!__atomic_load_n(&ah->queued, __ATOMIC_RELAXED)) {
+		pthread_mutex_lock(&pool_lock);
+		dect_audio_schedule(ah);
+		pthread_mutex_unlock(&pool_lock);
+	}
+	dect_trace_stage(DECT_TRACE_AUDIO);
+}
+
+/* Sinks must be added before the first frame is queued */
+void dect_audio_add_sink(struct dect_audio_handle *ah,
+			 struct dect_audio_sink *sink)
+{
+	list_add_tail(&sink->list, &ah->sinks);
 }
 
 struct dect_audio_handle *dect_audio_open(void)
 {
 	struct dect_audio_handle *ah;
+
+	if (pool_nthreads == 0)
+		return NULL;
+
+	ah = calloc(1, sizeof(*ah));
+	if (ah == NULL)
+		return NULL;
+
+	init_list_head(&ah->sinks);
+	return ah;
+}
+
+/*
+ * Pending frames are still processed, the handle and its sinks are released
+ * by the worker afterwards.
+ */
+void dect_audio_close(struct dect_audio_handle *ah)
+{
+	pthread_mutex_lock(&pool_lock);
+	ah->closed = true;
+	dect_audio_schedule(ah);
+	pthread_mutex_unlock(&pool_lock);
+}
+
+static int dect_audio_playback_init(void)
+{
 	SDL_AudioSpec spec = {
-		.freq		= 8000,
+		.freq		= DECT_AUDIO_MIXER_RATE,
 		.format		= AUDIO_S16SYS,
 		.channels	= 1,
-		.samples	= 512,
-		.callback	= dect_audio_dequeue,
+		.samples	= 1024,
+		.callback	= dect_audio_mix,
 	};
 
-	ah = malloc(sizeof(*ah));
-	if (ah == NULL)
+	if (SDL_Init(SDL_INIT_AUDIO) < 0)
 		goto err1;
-
-	ptrlist_init(&ah->queue[0]);
-	g72x_init_state(&ah->codec[0]);
-
-	ptrlist_init(&ah->queue[1]);
-	g72x_init_state(&ah->codec[1]);
-
-	spec.userdata = ah;
 	if (SDL_OpenAudio(&spec, NULL) < 0)
 		goto err2;
 	SDL_PauseAudio(0);
 
-	return ah;
+	mixer_enabled = true;
+	return 0;
 
 err2:
-	free(ah);
+	SDL_Quit();
 err1:
-	return NULL;
+	dectmon_log("audio: playback unavailable: %s\n", SDL_GetError());
+	return -1;
 }
 
-void dect_audio_close(struct dect_audio_handle *ah)
+int dect_audio_init(bool playback)
 {
-	struct dect_msg_buf *mb;
-	unsigned int i;
+	dect_g711_init();
 
-	SDL_CloseAudio();
-	for (i = 0; i < array_size(ah->queue); i++) {
-		while ((mb = ptrlist_dequeue_head(&ah->queue[i])) != NULL)
-			free(mb);
+	/* Recording and streaming don't depend on the mixer */
+	if (playback)
+		dect_audio_playback_init();
+
+	for (pool_nthreads = 0; pool_nthreads < DECT_AUDIO_WORKERS;
+	     pool_nthreads++) {
+		if (pthread_create(&pool_threads[pool_nthreads], NULL,
+				   dect_audio_worker, NULL))
+			break;
 	}
-	free(ah);
+	return pool_nthreads > 0 ? 0 : -1;
 }
 
-int dect_audio_init(void)
+void dect_audio_exit(void)
 {
-	return SDL_Init(SDL_INIT_AUDIO);
+	unsigned int i;
+
+	pthread_mutex_lock(&pool_lock);
+	pool_stop = true;
+	pthread_cond_broadcast(&pool_cond);
+	pthread_mutex_unlock(&pool_lock);
+
+	for (i = 0; i < pool_nthreads; i++)
+		pthread_join(pool_threads[i], NULL);
+	pool_nthreads = 0;
+
+	if (mixer_enabled) {
+		SDL_CloseAudio();
+		SDL_Quit();
+		mixer_enabled = false;
+	}
 }
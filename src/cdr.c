@@ -0,0 +1,171 @@
+/*
+ * dectmon call detail records
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <dect/libdect.h>
+#include <dectmon.h>
+#include <evlog.h>
+#include <cdr.h>
+
+static pthread_mutex_t cdr_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE *cdr_file;
+
+static uint64_t dect_cdr_now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+static void dect_cdr_set_bearer(struct dect_cdr *cdr,
+				const struct dect_tbc *tbc)
+{
+	cdr->end   = 0;
+	cdr->slot1 = tbc->slot1;
+	cdr->slot2 = tbc->slot2;
+	if (cdr->bearers < UINT8_MAX)
+		cdr->bearers++;
+	if (tbc->ciphered)
+		cdr->ciphered = true;
+}
+
+void dect_cdr_setup(struct dect_pt *pt)
+{
+	const struct dect_ipui *ipui = &pt->portable_identity->ipui;
+	struct dect_cdr *cdr;
+
+	if (pt->cdr != NULL)
+		return;
+
+	cdr = calloc(1, sizeof(*cdr));
+	if (cdr == NULL)
+		return;
+	cdr->setup = dect_cdr_now();
+	if (ipui->put == DECT_IPUI_N)
+		dect_format_ipei_string(&ipui->pun.n.ipei, cdr->ipui);
+	if (pt->dl != NULL && pt->dl->tbc != NULL)
+		dect_cdr_set_bearer(cdr, pt->dl->tbc);
+
+	pt->cdr = cdr;
+}
+
+/* Collect dialed digits, other keypad information is ignored */
+void dect_cdr_keypad(struct dect_pt *pt, const uint8_t *info, unsigned int len)
+{
+	struct dect_cdr *cdr = pt->cdr;
+	unsigned int i, n;
+
+	if (cdr == NULL)
+		return;
+
+	n = strlen(cdr->number);
+	for (i = 0; i < len && n < DECT_CDR_NUMBER_LEN; i++) {
+		if ((info[i] >= '0' && info[i] <= '9') ||
+		    info[i] == '*' || info[i] == '#' || info[i] == '+')
+			cdr->number[n++] = info[i];
+	}
+	cdr->number[n] = '\0';
+}
+
+void dect_cdr_connect(struct dect_pt *pt)
+{
+	if (pt->cdr != NULL && pt->cdr->connect == 0)
+		pt->cdr->connect = dect_cdr_now();
+}
+
+void dect_cdr_bearer(struct dect_pt *pt, const struct dect_tbc *tbc)
+{
+	if (pt->cdr != NULL)
+		dect_cdr_set_bearer(pt->cdr, tbc);
+}
+
+void dect_cdr_bearer_lost(struct dect_pt *pt)
+{
+	if (pt->cdr != NULL)
+		pt->cdr->end = dect_cdr_now();
+}
+
+void dect_cdr_cipher(struct dect_pt *pt)
+{
+	if (pt->cdr != NULL)
+		pt->cdr->ciphered = true;
+}
+
+static void dect_cdr_write(const char *cluster, const struct dect_cdr *cdr)
+{
+	uint64_t duration = 0;
+
+	if (cdr->connect)
+		duration = cdr->end - cdr->connect;
+
+	pthread_mutex_lock(&cdr_lock);
+	fprintf(cdr_file, "%s,%s,%s,%llu.%06u,%llu.%06u,%llu.%06u,%llu.%06u,"
+		"%u,%u,%u,%u,%s\n",
+		cluster ? cluster : "", cdr->ipui, cdr->number,
+		(unsigned long long)cdr->setup / 1000000,
+		(unsigned int)(cdr->setup % 1000000),
+		(unsigned long long)cdr->connect / 1000000,
+		(unsigned int)(cdr->connect % 1000000),
+		(unsigned long long)cdr->end / 1000000,
+		(unsigned int)(cdr->end % 1000000),
+		(unsigned long long)duration / 1000000,
+		(unsigned int)(duration % 1000000),
+		cdr->slot1, cdr->slot2, cdr->bearers, cdr->ciphered,
+		dect_cdr_cause_name(cdr->cause));
+	fflush(cdr_file);
+	pthread_mutex_unlock(&cdr_lock);
+}
+
+void dect_cdr_release(struct dect_handle *dh, struct dect_pt *pt,
+		      enum dect_cdr_causes cause)
+{
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	struct dect_cdr *cdr = pt->cdr;
+
+	if (cdr == NULL)
+		return;
+	pt->cdr = NULL;
+
+	if (cdr->end == 0)
+		cdr->end = dect_cdr_now();
+	cdr->cause = cause;
+
+	if (cdr_file != NULL)
+		dect_cdr_write(priv->cluster, cdr);
+	dect_evlog(cdr, priv->index, cdr);
+	free(cdr);
+}
+
+int dect_cdr_open(const char *name)
+{
+	cdr_file = fopen(name, "a");
+	if (cdr_file == NULL)
+		return -1;
+
+	fseek(cdr_file, 0, SEEK_END);
+	if (ftell(cdr_file) == 0)
+		fprintf(cdr_file, "cluster,ipui,number,setup,connect,end,"
+			"duration,slot1,slot2,bearers,ciphered,cause\n");
+	return 0;
+}
+
+void dect_cdr_close(void)
+{
+	if (cdr_file == NULL)
+		return;
+	fclose(cdr_file);
+	cdr_file = NULL;
+}
@@ -2,39 +2,116 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <readline/readline.h>
 #include <readline/history.h>
 #include <dectmon.h>
 #include <cli.h>
 
 #define DECTMON_HISTFILE	".dectmon_history"
+#define CLI_LINE_SIZE		1024
+
+/* Control socket connection in headless mode */
+struct cli_client {
+	struct list_head	list;
+	struct event		event;
+	int			fd;
+	unsigned int		len;
+	char			buf[CLI_LINE_SIZE];
+};
 
 static struct event cli_event;
 static char histfile[PATH_MAX];
 static struct parser_state state;
 static void *scanner;
 
-void cli_display(const char *fmt, va_list ap)
+static bool cli_headless;
+static const char *cli_ctlpath;
+static struct event cli_ctl_event;
+static int cli_ctl_fd = -1;
+static LIST_HEAD(cli_clients);
+
+/* Serializes readline between the CLI and the log sink thread */
+static pthread_mutex_t cli_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void cli_write_fd(int fd, const char *buf, size_t len)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = write(fd, buf, len);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return;
+		}
+		buf += ret;
+		len -= ret;
+	}
+}
+
+/*
+ * Headless output: the log sink hands over complete batches, write them
+ * out directly without any terminal handling. Control clients receive
+ * a copy of the output as far as their socket buffer permits.
+ */
+static void cli_write_headless(const char *buf, size_t len)
+{
+	struct cli_client *client;
+
+	cli_write_fd(STDOUT_FILENO, buf, len);
+
+	pthread_mutex_lock(&cli_lock);
+	list_for_each_entry(client, &cli_clients, list)
+		send(client->fd, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+	pthread_mutex_unlock(&cli_lock);
+}
+
+void cli_write(const char *buf, size_t len)
 {
 	int point, end;
 
+	if (cli_headless) {
+		cli_write_headless(buf, len);
+		return;
+	}
+
+	pthread_mutex_lock(&cli_lock);
 	point = rl_point;
 	end   = rl_end;
 	rl_point = rl_end = 0;
 	rl_save_prompt();
 	rl_clear_message();
 
-	vfprintf(rl_outstream, fmt, ap);
+	fwrite(buf, len, 1, rl_outstream);
 
 	rl_restore_prompt();
 	rl_point = point;
 	rl_end   = end;
 	rl_forced_update_display();
+	pthread_mutex_unlock(&cli_lock);
+}
+
+/* Commands run with all clusters stopped at an event boundary */
+static void cli_parse(const char *line)
+{
+	dect_handles_lock();
+	scanner_push_buffer(scanner, line);
+	yyparse(scanner, &state);
+	dect_handles_unlock();
+	dectmon_cluster_commit();
 }
 
 static void cli_read_callback(int fd, short mask, void *data)
 {
+	pthread_mutex_lock(&cli_lock);
 	rl_callback_read_char();
+	pthread_mutex_unlock(&cli_lock);
 }
 
 static void cli_complete(char *line)
@@ -61,19 +138,132 @@ static void cli_complete(char *line)
 		add_history(line);
 
 	rl_replace_line("", 1);
-	scanner_push_buffer(scanner, line);
-	yyparse(scanner, &state);
+	cli_parse(line);
 	rl_crlf();
 	free(line);
 }
 
+static void cli_client_close(struct cli_client *client)
+{
+	event_del(&client->event);
+	pthread_mutex_lock(&cli_lock);
+	list_del(&client->list);
+	pthread_mutex_unlock(&cli_lock);
+	close(client->fd);
+	free(client);
+}
+
+static void cli_client_read(int fd, short mask, void *data)
+{
+	struct cli_client *client = data;
+	char *line, *nl;
+	ssize_t len;
+
+	len = read(fd, client->buf + client->len,
+		   sizeof(client->buf) - client->len - 1);
+	if (len <= 0) {
+		if (len == 0 || errno != EINTR)
+			cli_client_close(client);
+		return;
+	}
+	client->len += len;
+	client->buf[client->len] = '\0';
+
+	line = client->buf;
+	while ((nl = strchr(line, '\n')) != NULL) {
+		*nl = '\0';
+		if (*line != '\0')
+			cli_parse(line);
+		line = nl + 1;
+	}
+
+	client->len -= line - client->buf;
+	memmove(client->buf, line, client->len);
+
+	/* discard overlong lines */
+	if (client->len == sizeof(client->buf) - 1)
+		client->len = 0;
+}
+
+static void cli_ctl_accept(int fd, short mask, void *data)
+{
+	struct cli_client *client;
+	int nfd;
+
+	nfd = accept(fd, NULL, NULL);
+	if (nfd < 0)
+		return;
+
+	client = calloc(1, sizeof(*client));
+	if (client == NULL) {
+		close(nfd);
+		return;
+	}
+	client->fd = nfd;
+	fcntl(nfd, F_SETFD, FD_CLOEXEC);
+
+	pthread_mutex_lock(&cli_lock);
+	list_add_tail(&client->list, &cli_clients);
+	pthread_mutex_unlock(&cli_lock);
+
+	event_set(&client->event, nfd, EV_READ | EV_PERSIST,
+		  cli_client_read, client);
+	event_add(&client->event, NULL);
+}
+
+static int cli_ctl_init(const char *path)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	/* Only replace stale sockets, never other files */
+	if (lstat(path, &st) == 0) {
+		if (!S_ISSOCK(st.st_mode)) {
+			errno = EEXIST;
+			return -1;
+		}
+		unlink(path);
+	}
+
+	cli_ctl_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (cli_ctl_fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	if (bind(cli_ctl_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    listen(cli_ctl_fd, 4) < 0) {
+		close(cli_ctl_fd);
+		cli_ctl_fd = -1;
+		return -1;
+	}
+	cli_ctlpath = path;
+
+	event_set(&cli_ctl_event, cli_ctl_fd, EV_READ | EV_PERSIST,
+		  cli_ctl_accept, NULL);
+	event_add(&cli_ctl_event, NULL);
+	return 0;
+}
+
 static const char *keywords[] = {
 	"debug",
 	"cluster",
 	"portable",
 	"tbc",
+	"trace",
+	"scan",
 	"show",
 	"set",
+	"reset",
+	"attach",
+	"detach",
 	"on",
 	"off",
 	"lce",
@@ -172,8 +362,32 @@ int cli_init(FILE *file)
 	return 0;
 }
 
+int cli_init_headless(const char *ctlpath)
+{
+	cli_headless = true;
+	parser_init(&state);
+	scanner = scanner_init(&state);
+
+	if (ctlpath != NULL)
+		return cli_ctl_init(ctlpath);
+	return 0;
+}
+
 void cli_exit(void)
 {
+	struct cli_client *client, *next;
+
+	if (cli_headless) {
+		list_for_each_entry_safe(client, next, &cli_clients, list)
+			cli_client_close(client);
+		if (cli_ctl_fd >= 0) {
+			event_del(&cli_ctl_event);
+			close(cli_ctl_fd);
+			unlink(cli_ctlpath);
+		}
+		return;
+	}
+
 	rl_callback_handler_remove();
 	rl_deprep_terminal();
 	write_history(histfile);
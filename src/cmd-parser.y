@@ -4,6 +4,7 @@
 #include <dect/libdect.h>
 #include <dectmon.h>
 #include <cli.h>
+#include <trace.h>
 
 #include "cmd-parser.h"
 #include "cmd-scanner.h"
@@ -99,9 +100,14 @@ static void location_update(struct location *loc, struct location *rhs, int n)
 %token CLUSTER			"cluster"
 %token PORTABLE			"portable"
 %token TBC			"tbc"
+%token TRACE			"trace"
+%token SCAN			"scan"
 
 %token SHOW			"show"
 %token SET			"set"
+%token RESET			"reset"
+%token ATTACH			"attach"
+%token DETACH			"detach"
 
 %token ON			"on"
 %token OFF			"off"
@@ -188,6 +194,8 @@ input			:	/* empty */
 line			:	cluster_stmt
 			|	portable_stmt
 			|	tbc_stmt
+			|	trace_stmt
+			|	scan_stmt
 			|	debug_stmt
 			|	cc_primitive
 			|	ss_primitive
@@ -204,6 +212,16 @@ cluster_stmt		:	CLUSTER		SHOW
 						    priv->pari.emc, priv->pari.fpn);
 				}
 			}
+			|	CLUSTER		ATTACH		STRING
+			{
+				dectmon_cluster_attach($3);
+				free($3);
+			}
+			|	CLUSTER		DETACH		STRING
+			{
+				dectmon_cluster_detach($3);
+				free($3);
+			}
 			;
 
 portable_stmt		:	PORTABLE	SHOW
@@ -245,6 +263,26 @@ tbc_stmt		:	TBC		SHOW
 			}
 			;
 
+scan_stmt		:	SCAN		SHOW
+			{
+				dect_scan_show();
+			}
+			;
+
+trace_stmt		:	TRACE		SHOW
+			{
+				dect_trace_show();
+			}
+			|	TRACE		RESET
+			{
+				dect_trace_reset();
+			}
+			|	TRACE		on_off
+			{
+				dect_trace_enabled = $2;
+			}
+			;
+
 debug_stmt		:	TOK_DEBUG	SET	debug_subsys	on_off
 			{
 				if ($4)
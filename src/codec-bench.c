@@ -0,0 +1,265 @@
+/*
+ * dectmon codec benchmark
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Measures the throughput of the reference G.711/G.721/G.723 coders and the
+ * block decoders used by dectmon, and verifies that the block decoders are
+ * bit-exact with the reference implementation for a synthetic test signal
+ * and with the G.722 reference vectors. Exits with status 1 if any output
+ * differs.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include <utils.h>
+#include <adpcm.h>
+#include <g711.h>
+#include <g722.h>
+#include "g722-vectors.h"
+
+#define BENCH_DEFAULT_SAMPLES	(8000 * 1000)
+
+static unsigned int nsamples;
+static int16_t *pcm;
+static uint8_t *codes;
+static uint8_t *packed;
+static int16_t *ref;
+static int16_t *out;
+static bool failed;
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_report(const char *name, double start, unsigned int n)
+{
+	double t = bench_now() - start;
+
+	printf("%-24s %10.2f Msamples/s\n", name, n / t / 1e6);
+}
+
+static void bench_verify(const char *name, const int16_t *a, const int16_t *b,
+			 unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		if (a[i] != b[i]) {
+			printf("%-24s MISMATCH at sample %u: %d != %d\n",
+			       name, i, a[i], b[i]);
+			failed = true;
+			return;
+		}
+	}
+	printf("%-24s bit-exact\n", name);
+}
+
+/*
+ * Test signal: a tone sweeping over the voice band with varying amplitude,
+ * noise and periodic full-scale square bursts to exercise saturation.
+ */
+static void bench_signal(void)
+{
+	uint32_t seed = 1, phase = 0, step;
+	unsigned int i;
+	int tri, amp, v;
+
+	for (i = 0; i < nsamples; i++) {
+		seed = seed * 1103515245 + 12345;
+		step = 0x00800000 + (i % 80000) * 0x1000;
+		phase += step;
+		tri = (int)(phase >> 16) - 0x8000;
+		tri = (tri < 0 ? -tri : tri) * 2 - 0x8000;
+		amp = (i / 4000) % 16;
+		v = (tri >> (15 - amp)) + ((int)(seed >> 16) - 0x8000) / 64;
+		if ((i / 8000) % 10 == 9)
+			v = phase & 0x80000000 ? 32767 : -32768;
+		pcm[i] = v > 32767 ? 32767 : v < -32768 ? -32768 : v;
+	}
+}
+
+static void bench_g711(void)
+{
+	unsigned int i;
+	double start;
+
+	start = bench_now();
+	for (i = 0; i < nsamples; i++)
+		codes[i] = linear2alaw(pcm[i]);
+	bench_report("G.711 A-law encode (ref)", start, nsamples);
+
+	start = bench_now();
+	dect_alaw_encode(packed, pcm, nsamples);
+	bench_report("G.711 A-law encode", start, nsamples);
+	for (i = 0; i < nsamples; i++) {
+		ref[i] = codes[i];
+		out[i] = packed[i];
+	}
+	bench_verify("G.711 A-law encode", ref, out, nsamples);
+
+	start = bench_now();
+	for (i = 0; i < nsamples; i++)
+		ref[i] = alaw2linear(codes[i]);
+	bench_report("G.711 A-law decode (ref)", start, nsamples);
+
+	start = bench_now();
+	dect_alaw_decode(out, codes, nsamples);
+	bench_report("G.711 A-law decode", start, nsamples);
+	bench_verify("G.711 A-law decode", ref, out, nsamples);
+
+	start = bench_now();
+	for (i = 0; i < nsamples; i++)
+		codes[i] = linear2ulaw(pcm[i]);
+	bench_report("G.711 u-law encode (ref)", start, nsamples);
+
+	start = bench_now();
+	dect_ulaw_encode(packed, pcm, nsamples);
+	bench_report("G.711 u-law encode", start, nsamples);
+	for (i = 0; i < nsamples; i++) {
+		ref[i] = codes[i];
+		out[i] = packed[i];
+	}
+	bench_verify("G.711 u-law encode", ref, out, nsamples);
+
+	start = bench_now();
+	for (i = 0; i < nsamples; i++)
+		ref[i] = ulaw2linear(codes[i]);
+	bench_report("G.711 u-law decode (ref)", start, nsamples);
+
+	start = bench_now();
+	dect_ulaw_decode(out, codes, nsamples);
+	bench_report("G.711 u-law decode", start, nsamples);
+	bench_verify("G.711 u-law decode", ref, out, nsamples);
+}
+
+static void bench_g721(void)
+{
+	struct g72x_state state;
+	unsigned int i;
+	double start;
+
+	g72x_init_state(&state);
+	start = bench_now();
+	for (i = 0; i < nsamples; i++)
+		codes[i] = g721_encoder(pcm[i], AUDIO_ENCODING_LINEAR, &state);
+	bench_report("G.721 encode (ref)", start, nsamples);
+
+	g72x_init_state(&state);
+	start = bench_now();
+	for (i = 0; i < nsamples; i++)
+		ref[i] = g721_decoder(codes[i], AUDIO_ENCODING_LINEAR, &state);
+	bench_report("G.721 decode (ref)", start, nsamples);
+
+	for (i = 0; i < nsamples / 2; i++)
+		packed[i] = codes[2 * i] << 4 | codes[2 * i + 1];
+
+	g72x_init_state(&state);
+	start = bench_now();
+	dect_g721_decode(&state, out, packed, nsamples / 2);
+	bench_report("G.721 decode", start, nsamples & ~1U);
+	bench_verify("G.721 decode", ref, out, nsamples & ~1U);
+}
+
+static void bench_g723(const char *name, int (*encode)(int, int,
+						       struct g72x_state *),
+		       int (*decode)(int, int, struct g72x_state *))
+{
+	struct g72x_state state;
+	char desc[32];
+	unsigned int i;
+	double start;
+
+	g72x_init_state(&state);
+	start = bench_now();
+	for (i = 0; i < nsamples; i++)
+		codes[i] = encode(pcm[i], AUDIO_ENCODING_LINEAR, &state);
+	snprintf(desc, sizeof(desc), "%s encode (ref)", name);
+	bench_report(desc, start, nsamples);
+
+	g72x_init_state(&state);
+	start = bench_now();
+	for (i = 0; i < nsamples; i++)
+		ref[i] = decode(codes[i], AUDIO_ENCODING_LINEAR, &state);
+	snprintf(desc, sizeof(desc), "%s decode (ref)", name);
+	bench_report(desc, start, nsamples);
+}
+
+static void bench_g722(void)
+{
+	struct dect_g722_state state;
+	unsigned int i;
+	double start;
+
+	/* Each octet decodes to two samples, any octet is a valid code word */
+	for (i = 0; i < nsamples / 2; i++)
+		packed[i] = linear2alaw(pcm[2 * i]);
+
+	dect_g722_init(&state);
+	start = bench_now();
+	dect_g722_decode(&state, out, packed, nsamples / 2);
+	bench_report("G.722 decode", start, nsamples & ~1U);
+
+	for (i = 0; i < array_size(g722_vectors); i++) {
+		int16_t samples[2 * G722_VECTOR_CODES];
+		char desc[32];
+
+		dect_g722_init(&state);
+		dect_g722_decode(&state, samples, g722_vectors[i].code,
+				 G722_VECTOR_CODES);
+		snprintf(desc, sizeof(desc), "G.722 decode (%s)",
+			 g722_vectors[i].name);
+		bench_verify(desc, g722_vectors[i].pcm, samples,
+			     2 * G722_VECTOR_CODES);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	nsamples = BENCH_DEFAULT_SAMPLES;
+	if (argc > 1)
+		nsamples = strtoul(argv[1], NULL, 10);
+	if (argc > 2 || nsamples == 0) {
+		fprintf(stderr, "%s [ samples ]\n", argv[0]);
+		return 1;
+	}
+
+	pcm	= malloc(nsamples * sizeof(pcm[0]));
+	codes	= malloc(nsamples * sizeof(codes[0]));
+	packed	= malloc(nsamples * sizeof(packed[0]));
+	ref	= malloc(nsamples * sizeof(ref[0]));
+	out	= malloc(nsamples * sizeof(out[0]));
+	if (!pcm || !codes || !packed || !ref || !out) {
+		perror("malloc");
+		return 1;
+	}
+
+	dect_g711_init();
+	bench_signal();
+
+	bench_g711();
+	bench_g721();
+	bench_g723("G.723 24kbit", g723_24_encoder, g723_24_decoder);
+	bench_g723("G.723 40kbit", g723_40_encoder, g723_40_decoder);
+	bench_g722();
+
+	free(out);
+	free(ref);
+	free(packed);
+	free(codes);
+	free(pcm);
+	return failed ? 1 : 0;
+}
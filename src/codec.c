@@ -0,0 +1,108 @@
+/*
+ * dectmon speech codecs
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <dect/libdect.h>
+#include <utils.h>
+#include <adpcm.h>
+#include <g711.h>
+#include <codec.h>
+
+static void dect_g726_init(union dect_codec_state *state)
+{
+	g72x_init_state(&state->g721);
+}
+
+static void dect_g726_decode(union dect_codec_state *state, int16_t *dst,
+			     const uint8_t *src, unsigned int len)
+{
+	dect_g721_decode(&state->g721, dst, src, len);
+}
+
+static void dect_g722_codec_init(union dect_codec_state *state)
+{
+	dect_g722_init(&state->g722);
+}
+
+static void dect_g722_codec_decode(union dect_codec_state *state,
+				   int16_t *dst, const uint8_t *src,
+				   unsigned int len)
+{
+	dect_g722_decode(&state->g722, dst, src, len);
+}
+
+static void dect_g711_codec_init(union dect_codec_state *state)
+{
+}
+
+static void dect_g711a_decode(union dect_codec_state *state, int16_t *dst,
+			      const uint8_t *src, unsigned int len)
+{
+	dect_alaw_decode(dst, src, len);
+}
+
+static void dect_g711u_decode(union dect_codec_state *state, int16_t *dst,
+			      const uint8_t *src, unsigned int len)
+{
+	dect_ulaw_decode(dst, src, len);
+}
+
+static const struct dect_codec dect_codecs[] = {
+	{
+		.id		= DECT_CODEC_G726_32KBIT,
+		.name		= "G.726",
+		.rate		= 8000,
+		.frame_size	= 40,
+		.frame_samples	= 80,
+		.init		= dect_g726_init,
+		.decode		= dect_g726_decode,
+	},
+	{
+		.id		= DECT_CODEC_G722_64KBIT,
+		.name		= "G.722",
+		.rate		= 16000,
+		.frame_size	= 80,
+		.frame_samples	= 160,
+		.init		= dect_g722_codec_init,
+		.decode		= dect_g722_codec_decode,
+	},
+	{
+		.id		= DECT_CODEC_G711_ALAW_64KBIT,
+		.name		= "G.711 A-law",
+		.rate		= 8000,
+		.frame_size	= 80,
+		.frame_samples	= 80,
+		.init		= dect_g711_codec_init,
+		.decode		= dect_g711a_decode,
+	},
+	{
+		.id		= DECT_CODEC_G711_ULAW_64KBIT,
+		.name		= "G.711 u-law",
+		.rate		= 8000,
+		.frame_size	= 80,
+		.frame_samples	= 80,
+		.init		= dect_g711_codec_init,
+		.decode		= dect_g711u_decode,
+	},
+};
+
+/* Returns NULL for codecs which can not be decoded */
+const struct dect_codec *dect_codec_lookup(enum dect_codecs id)
+{
+	unsigned int i;
+
+	for (i = 0; i < array_size(dect_codecs); i++) {
+		if (dect_codecs[i].id == id)
+			return &dect_codecs[i];
+	}
+	return NULL;
+}
@@ -13,30 +13,81 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <unistd.h>
-#include <ctype.h>
 
 #include <dect/libdect.h>
 #include <dectmon.h>
+#include <utils.h>
+#include <log.h>
 
 #define BLOCKSIZE	16
+#define HEXDUMP_WIDTH	64
+#define HEXDUMP_BUFSIZE	(DECTMON_LOG_MSG_SIZE - 1)
 
-void dect_hexdump(const char *prefix, const uint8_t *buf, size_t size)
+static const char hexdigits[] = "0123456789abcdef";
+
+/*
+ * Format one line of at most BLOCKSIZE bytes:
+ *
+ * <prefix>: <hex bytes, padded to HEXDUMP_WIDTH - prefix width>    |<ascii>|
+ */
+static unsigned int dect_hexdump_line(char *p, const char *prefix,
+				      unsigned int plen, unsigned int hwidth,
+				      const uint8_t *buf, unsigned int len)
 {
-	unsigned int i, off, plen = 0;
-	char hbuf[3 * BLOCKSIZE + 1], abuf[BLOCKSIZE + 1];
+	char *start = p;
+	unsigned int i;
+
+	memcpy(p, prefix, plen);
+	p += plen;
+	*p++ = ':';
+	*p++ = ' ';
+
+	for (i = 0; i < len; i++) {
+		*p++ = hexdigits[buf[i] >> 4];
+		*p++ = hexdigits[buf[i] & 0xf];
+		*p++ = ' ';
+	}
+	for (i = 3 * len; i < hwidth; i++)
+		*p++ = ' ';
 
-	for (i = 0; i < strlen(prefix); i++)
-		plen += prefix[i] == '\t' ? 8 : 1;
+	memcpy(p, "    |", 5);
+	p += 5;
+	for (i = 0; i < len; i++)
+		*p++ = buf[i] >= 0x20 && buf[i] < 0x7f ? buf[i] : '.';
+	*p++ = '|';
+	*p++ = '\n';
+
+	return p - start;
+}
+
+/*
+ * Hexdump a buffer, handing complete lines to the log in as few records
+ * as possible.
+ */
+void dect_hexdump(const char *prefix, const uint8_t *buf, size_t size)
+{
+	unsigned int i, plen, pwidth = 0, hwidth = 0, llen, len = 0;
+	char out[HEXDUMP_BUFSIZE];
 
-	for (i = 0; i < size; i++) {
-		off = i % BLOCKSIZE;
+	plen = strlen(prefix);
+	for (i = 0; i < plen; i++)
+		pwidth += prefix[i] == '\t' ? 8 : 1;
+	if (pwidth < HEXDUMP_WIDTH)
+		hwidth = HEXDUMP_WIDTH - pwidth;
 
-		sprintf(hbuf + 3 * off, "%.2x ", buf[i]);
-		abuf[off] = isascii(buf[i]) && isprint(buf[i]) ? buf[i] : '.';
+	/* Maximum size of a single line */
+	llen = plen + 2 + max(hwidth, 3U * BLOCKSIZE) + 5 + BLOCKSIZE + 2;
+	if (llen > sizeof(out))
+		return;
 
-		if (off == BLOCKSIZE - 1 || i == size - 1) {
-			abuf[off + 1] = '\0';
-			dectmon_log("%s: %-*s    |%s|\n", prefix, 64 - plen, hbuf, abuf);
+	for (i = 0; i < size; i += BLOCKSIZE) {
+		if (len + llen > sizeof(out)) {
+			dectmon_log_buf(out, len);
+			len = 0;
 		}
+		len += dect_hexdump_line(out + len, prefix, plen, hwidth, buf + i,
+					 min(size - i, (size_t)BLOCKSIZE));
 	}
+	if (len > 0)
+		dectmon_log_buf(out, len);
 }
@@ -15,6 +15,7 @@
 #include <dectmon.h>
 #include <mac.h>
 #include <dlc.h>
+#include <trace.h>
 
 #define dlc_print(fmt, args...)				\
 	do {						\
@@ -141,6 +142,7 @@ void dect_mac_co_data_ind(struct dect_handle *dh, struct dect_mac_con *mc,
 
 	mb = dect_lc_reassemble(dh, mc->lc, chan, mb);
 	if (mb != NULL) {
+		dect_trace_stage(DECT_TRACE_DLC);
 		if (mb->len > DECT_FA_HDR_SIZE) {
 			dect_mbuf_pull(mb, DECT_FA_HDR_SIZE);
 			dect_dl_data_ind(dh, &mc->tbc->dl, mb);
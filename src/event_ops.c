@@ -7,94 +7,370 @@
  */
 
 #include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <signal.h>
 
 #include <dect/libdect.h>
 #include <dectmon.h>
+#include <utils.h>
 #include <ops.h>
 
+/*
+ * Every cluster runs its own loop in a separate thread. libdect file
+ * descriptors are dispatched through a per-loop epoll set, timers are kept
+ * in a sorted list which determines the epoll timeout. The loop lock is
+ * held while processing events and released while waiting, other threads
+ * (the CLI) take it to access the cluster's handle.
+ *
+ * The main thread runs libevent for the CLI and signal handling.
+ */
+#define EPOLL_MAX_EVENTS	64
+
+struct dect_loop {
+	pthread_mutex_t			lock;
+	int				epoll_fd;
+	int				wake_fd;
+	struct list_head		timers;
+	pthread_mutex_t			work_lock;
+	struct list_head		work;
+	bool				stop;
+};
+
 struct io_event {
+	struct dect_loop		*loop;
 	const struct dect_handle	*dh;
-	struct event			ev;
+	dect_fd_batch_t			batch;
 };
 
-static void event_io_callback(int fd, short mask, void *data)
+struct timer_event {
+	struct list_head		list;
+	struct dect_loop		*loop;
+	const struct dect_handle	*dh;
+	struct dect_timer		*timer;
+	uint64_t			expires;
+	bool				pending;
+};
+
+/* Loop of the handle currently being opened by this thread */
+static __thread struct dect_loop *dect_loop_current;
+
+static struct dect_loop *dect_handle_loop(const struct dect_handle *dh)
 {
-	struct dect_fd *dfd = data;
-	struct io_event *ioe = dect_fd_priv(dfd);
-	uint32_t events;
+	struct dect_handle_priv *priv;
 
-	events = 0;
-	if (mask & EV_READ)
-		events |= DECT_FD_READ;
-	if (mask & EV_WRITE)
-		events |= DECT_FD_WRITE;
+	priv = dect_handle_priv((struct dect_handle *)dh);
+	return priv->loop ? priv->loop : dect_loop_current;
+}
+
+static uint64_t dect_loop_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-	dect_fd_process((struct dect_handle *)ioe->dh, dfd, events);
+static void dect_loop_wakeup(struct dect_loop *loop)
+{
+	uint64_t val = 1;
+
+	if (write(loop->wake_fd, &val, sizeof(val)) < 0)
+		return;
 }
 
 static int register_fd(const struct dect_handle *dh, struct dect_fd *dfd,
 		       uint32_t events)
 {
 	struct io_event *ioe = dect_fd_priv(dfd);
-	unsigned short mask;
+	struct epoll_event ev = {
+		.data.ptr	= dfd,
+	};
 
-	mask = EV_PERSIST;
 	if (events & DECT_FD_READ)
-		mask |= EV_READ;
+		ev.events |= EPOLLIN;
 	if (events & DECT_FD_WRITE)
-		mask |= EV_WRITE;
+		ev.events |= EPOLLOUT;
 
-	ioe->dh = dh;
-	event_set(&ioe->ev, dect_fd_num(dfd), mask, event_io_callback, dfd);
-	event_add(&ioe->ev, NULL);
-	return 0;
+	ioe->loop  = dect_handle_loop(dh);
+	ioe->dh	   = dh;
+	ioe->batch = NULL;
+	return epoll_ctl(ioe->loop->epoll_fd, EPOLL_CTL_ADD,
+			 dect_fd_num(dfd), &ev);
 }
 
 static void unregister_fd(const struct dect_handle *dh, struct dect_fd *dfd)
 {
 	struct io_event *ioe = dect_fd_priv(dfd);
 
-	event_del(&ioe->ev);
+	epoll_ctl(ioe->loop->epoll_fd, EPOLL_CTL_DEL, dect_fd_num(dfd), NULL);
 }
 
-static void event_timer_callback(int fd, short mask, void *data)
+/**
+ * dect_event_fd_batch - process read events on a file descriptor in batches
+ *
+ * @dfd:	registered libdect file descriptor
+ * @batch:	handler called instead of dect_fd_process() on read events,
+ *		expected to consume all pending data
+ */
+void dect_event_fd_batch(struct dect_fd *dfd, dect_fd_batch_t batch)
 {
-	struct dect_timer *timer = data;
-	struct io_event *ioe = dect_timer_priv(timer);
+	struct io_event *ioe = dect_fd_priv(dfd);
 
-	dect_timer_run((struct dect_handle *)ioe->dh, data);
+	ioe->batch = batch;
 }
 
 static void start_timer(const struct dect_handle *dh,
 			struct dect_timer *timer,
 			const struct timeval *tv)
 {
-	struct io_event *ioe = dect_timer_priv(timer);
+	struct timer_event *te = dect_timer_priv(timer);
+	struct timer_event *pos;
+
+	if (te->pending)
+		list_del(&te->list);
+
+	te->loop    = dect_handle_loop(dh);
+	te->dh	    = dh;
+	te->timer   = timer;
+	te->expires = dect_loop_now() + tv->tv_sec * 1000000000ULL +
+		      tv->tv_usec * 1000ULL;
+	te->pending = true;
 
-	ioe->dh = dh;
-	evtimer_set(&ioe->ev, event_timer_callback, timer);
-	evtimer_add(&ioe->ev, (struct timeval *)tv);
+	list_for_each_entry(pos, &te->loop->timers, list) {
+		if (pos->expires > te->expires)
+			break;
+	}
+	list_add_tail(&te->list, &pos->list);
+
+	/* The loop may be waiting with a later timeout */
+	if (te->loop->timers.next == &te->list)
+		dect_loop_wakeup(te->loop);
 }
 
 static void stop_timer(const struct dect_handle *dh, struct dect_timer *timer)
 {
-	struct io_event *ioe = dect_timer_priv(timer);
+	struct timer_event *te = dect_timer_priv(timer);
 
-	evtimer_del(&ioe->ev);
+	if (!te->pending)
+		return;
+	list_del(&te->list);
+	te->pending = false;
 }
 
 static const struct dect_event_ops dect_event_ops = {
 	.fd_priv_size		= sizeof(struct io_event),
 	.register_fd		= register_fd,
 	.unregister_fd		= unregister_fd,
-	.timer_priv_size	= sizeof(struct io_event),
+	.timer_priv_size	= sizeof(struct timer_event),
 	.start_timer		= start_timer,
 	.stop_timer		= stop_timer
 };
 
+struct dect_loop *dect_loop_alloc(void)
+{
+	struct dect_loop *loop;
+	struct epoll_event ev = {
+		.events		= EPOLLIN,
+		.data.ptr	= NULL,
+	};
+
+	loop = calloc(1, sizeof(*loop));
+	if (loop == NULL)
+		return NULL;
+
+	pthread_mutex_init(&loop->lock, NULL);
+	pthread_mutex_init(&loop->work_lock, NULL);
+	init_list_head(&loop->timers);
+	init_list_head(&loop->work);
+
+	loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epoll_fd < 0)
+		goto err1;
+	loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (loop->wake_fd < 0)
+		goto err2;
+	if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &ev) < 0)
+		goto err3;
+	return loop;
+
+err3:
+	close(loop->wake_fd);
+err2:
+	close(loop->epoll_fd);
+err1:
+	pthread_mutex_destroy(&loop->work_lock);
+	pthread_mutex_destroy(&loop->lock);
+	free(loop);
+	return NULL;
+}
+
+/* Work queued to a loop that has been stopped is discarded */
+void dect_loop_free(struct dect_loop *loop)
+{
+	close(loop->wake_fd);
+	close(loop->epoll_fd);
+	pthread_mutex_destroy(&loop->work_lock);
+	pthread_mutex_destroy(&loop->lock);
+	free(loop);
+}
+
+/**
+ * dect_loop_queue_work - run a function in the context of a loop
+ *
+ * @loop:	target loop
+ * @work:	work item, queued only once until it has run
+ *
+ * The work function is called by the loop's thread with the loop lock
+ * held. May be called from any thread without holding the loop lock.
+ */
+void dect_loop_queue_work(struct dect_loop *loop, struct dect_loop_work *work)
+{
+	pthread_mutex_lock(&loop->work_lock);
+	if (!work->pending) {
+		work->pending = true;
+		list_add_tail(&work->list, &loop->work);
+	}
+	pthread_mutex_unlock(&loop->work_lock);
+	dect_loop_wakeup(loop);
+}
+
+static void dect_loop_run_work(struct dect_loop *loop)
+{
+	struct dect_loop_work *work;
+
+	for (;;) {
+		pthread_mutex_lock(&loop->work_lock);
+		if (list_empty(&loop->work)) {
+			pthread_mutex_unlock(&loop->work_lock);
+			break;
+		}
+		work = list_first_entry(&loop->work, struct dect_loop_work, list);
+		list_del(&work->list);
+		work->pending = false;
+		pthread_mutex_unlock(&loop->work_lock);
+
+		work->func(work);
+	}
+}
+
+/* Make @loop the loop for handles opened by the calling thread */
+void dect_loop_set_current(struct dect_loop *loop)
+{
+	dect_loop_current = loop;
+}
+
+void dect_loop_lock(struct dect_loop *loop)
+{
+	pthread_mutex_lock(&loop->lock);
+}
+
+void dect_loop_unlock(struct dect_loop *loop)
+{
+	pthread_mutex_unlock(&loop->lock);
+}
+
+static int dect_loop_timeout(const struct dect_loop *loop)
+{
+	const struct timer_event *te;
+	uint64_t now;
+
+	if (list_empty(&loop->timers))
+		return -1;
+
+	te  = list_first_entry(&loop->timers, struct timer_event, list);
+	now = dect_loop_now();
+	if (te->expires <= now)
+		return 0;
+	return div_round_up(te->expires - now, 1000000ULL);
+}
+
+static void dect_loop_run_timers(struct dect_loop *loop)
+{
+	struct timer_event *te;
+	uint64_t now = dect_loop_now();
+
+	/* Timer callbacks may start or stop other timers, so restart the
+	 * walk from the list head after each one.
+	 */
+	while (!list_empty(&loop->timers)) {
+		te = list_first_entry(&loop->timers, struct timer_event, list);
+		if (te->expires > now)
+			break;
+
+		list_del(&te->list);
+		te->pending = false;
+		dect_timer_run((struct dect_handle *)te->dh, te->timer);
+	}
+}
+
+static void dect_loop_process(struct dect_loop *loop,
+			      const struct epoll_event *events, int n)
+{
+	struct io_event *ioe;
+	struct dect_fd *dfd;
+	uint32_t flags;
+	uint64_t val;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		dfd = events[i].data.ptr;
+		if (dfd == NULL) {
+			/* wakeup, the timeout is recalculated by the caller */
+			while (read(loop->wake_fd, &val, sizeof(val)) > 0)
+				;
+			continue;
+		}
+		ioe = dect_fd_priv(dfd);
+
+		flags = 0;
+		if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+			flags |= DECT_FD_READ;
+		if (events[i].events & EPOLLOUT)
+			flags |= DECT_FD_WRITE;
+
+		if (ioe->batch != NULL && flags == DECT_FD_READ)
+			ioe->batch((struct dect_handle *)ioe->dh, dfd);
+		else
+			dect_fd_process((struct dect_handle *)ioe->dh, dfd, flags);
+	}
+}
+
+void dect_loop_run(struct dect_loop *loop)
+{
+	struct epoll_event events[EPOLL_MAX_EVENTS];
+	int timeout, n;
+
+	pthread_mutex_lock(&loop->lock);
+	while (!loop->stop) {
+		timeout = dect_loop_timeout(loop);
+		pthread_mutex_unlock(&loop->lock);
+
+		n = epoll_wait(loop->epoll_fd, events, array_size(events),
+			       timeout);
+
+		pthread_mutex_lock(&loop->lock);
+		if (n > 0)
+			dect_loop_process(loop, events, n);
+		dect_loop_run_timers(loop);
+		dect_loop_run_work(loop);
+	}
+	pthread_mutex_unlock(&loop->lock);
+}
+
+void dect_loop_stop(struct dect_loop *loop)
+{
+	pthread_mutex_lock(&loop->lock);
+	loop->stop = true;
+	pthread_mutex_unlock(&loop->lock);
+	dect_loop_wakeup(loop);
+}
+
 static struct event_base *ev_base;
 static struct event sig_event;
 static bool sigint;
@@ -0,0 +1,216 @@
+/*
+ * dectmon binary event log pretty printer
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include <dect/libdect.h>
+#include <dectmon.h>
+#include <evlog.h>
+#include <mac.h>
+#include <nwk.h>
+#include <cdr.h>
+
+#define EVLOG_MAX_CLUSTERS	256
+
+static char *cluster_names[EVLOG_MAX_CLUSTERS];
+
+void dectmon_log(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+}
+
+void dectmon_log_buf(const char *buf, unsigned int len)
+{
+	fwrite(buf, len, 1, stdout);
+}
+
+static const char * const bearer_events[] = {
+	[DECT_EV_BEARER_ESTABLISH]	= "establish",
+	[DECT_EV_BEARER_RELEASE]	= "release",
+	[DECT_EV_BEARER_TIMEOUT]	= "timeout",
+	[DECT_EV_BEARER_CIPHER]		= "ciphering enabled",
+};
+
+static void evlog_print_hdr(const struct dect_evlog_hdr *hdr)
+{
+	const char *name = cluster_names[hdr->cluster];
+	char tbuf[32];
+	struct tm tm;
+	time_t t;
+
+	t = hdr->tstamp / 1000000;
+	localtime_r(&t, &tm);
+	strftime(tbuf, sizeof(tbuf), "%H:%M:%S", &tm);
+
+	printf("%s.%06u %s: MFN: %u frame: %2u ", tbuf,
+	       (unsigned int)(hdr->tstamp % 1000000),
+	       name ? name : "?",
+	       DECT_EV_FRAME_MFN(hdr->frame), DECT_EV_FRAME_NUM(hdr->frame));
+}
+
+static void evlog_print_mac(const struct dect_evlog_hdr *hdr,
+			    const struct dect_ev_mac *ev)
+{
+	unsigned int i;
+
+	evlog_print_hdr(hdr);
+	printf("slot: %02u A: %x B: %x T:", ev->slot,
+	       (ev->data[0] & DECT_HDR_TA_MASK) >> DECT_HDR_TA_SHIFT,
+	       (ev->data[0] & DECT_HDR_BA_MASK) >> DECT_HDR_BA_SHIFT);
+	for (i = 0; i < DECT_T_FIELD_SIZE; i++)
+		printf(" %.2x", ev->data[DECT_T_FIELD_OFF + i]);
+	printf("\n");
+}
+
+static void evlog_print_bearer(const struct dect_evlog_hdr *hdr,
+			       const struct dect_ev_bearer *ev)
+{
+	const char *event = "unknown";
+
+	if (ev->event < array_size(bearer_events))
+		event = bearer_events[ev->event];
+
+	evlog_print_hdr(hdr);
+	printf("TBC: PMID: %.5x FMID: %.3x: %s: slot %u/%u ciphered: %s\n",
+	       ev->pmid, ev->fmid, event, ev->slot1, ev->slot2,
+	       ev->ciphered ? "yes" : "no");
+}
+
+static void evlog_print_nwk(const struct dect_evlog_hdr *hdr,
+			    const struct dect_ev_nwk *ev)
+{
+	unsigned int len = hdr->len - sizeof(*ev), off, ielen;
+	const uint8_t *data = ev->data;
+	const char *name = NULL;
+	char prefix[16];
+
+	if (len >= 2)
+		name = nwk_msg_types[data[1]];
+
+	evlog_print_hdr(hdr);
+	printf("PMID: %.5x %s {%s} message:\n", ev->pmid,
+	       ev->slot < DECT_HALF_FRAME_SIZE ? "FP->PP" : "PP->FP",
+	       name ? name : "unknown");
+	dect_hexdump("NWK", data, len);
+
+	/* s-format IEs: fixed length IEs have the MSB set, double octet
+	 * elements carry one octet of content, all others are TLV encoded.
+	 */
+	for (off = 2; off < len; off += ielen) {
+		if (data[off] & 0x80)
+			ielen = (data[off] & 0xf0) == 0xe0 ? 2 : 1;
+		else if (off + 1 < len)
+			ielen = 2 + data[off + 1];
+		else
+			break;
+
+		if (off + ielen > len)
+			ielen = len - off;
+		snprintf(prefix, sizeof(prefix), "\tIE %.2x", data[off]);
+		dect_hexdump(prefix, data + off, ielen);
+	}
+	printf("\n");
+}
+
+static void evlog_print_cdr(const struct dect_evlog_hdr *hdr,
+			    const struct dect_cdr *cdr)
+{
+	evlog_print_hdr(hdr);
+	printf("CDR: IPUI: %.*s number: %.*s setup: %llu.%06u",
+	       DECT_CDR_IPUI_LEN, cdr->ipui, DECT_CDR_NUMBER_LEN, cdr->number,
+	       (unsigned long long)cdr->setup / 1000000,
+	       (unsigned int)(cdr->setup % 1000000));
+	if (cdr->connect)
+		printf(" duration: %llus",
+		       (unsigned long long)(cdr->end - cdr->connect) / 1000000);
+	printf(" slots: %u/%u bearers: %u ciphered: %s cause: %s\n",
+	       cdr->slot1, cdr->slot2, cdr->bearers,
+	       cdr->ciphered ? "yes" : "no", dect_cdr_cause_name(cdr->cause));
+}
+
+static void evlog_cluster(const struct dect_evlog_hdr *hdr, const char *name)
+{
+	free(cluster_names[hdr->cluster]);
+	cluster_names[hdr->cluster] = strndup(name, hdr->len);
+}
+
+int main(int argc, char **argv)
+{
+	struct dect_evlog_file_hdr fhdr;
+	struct dect_evlog_hdr hdr;
+	static uint8_t buf[65536];
+	FILE *f = stdin;
+
+	if (argc > 2) {
+		fprintf(stderr, "%s [ FILE ]\n", argv[0]);
+		exit(1);
+	}
+
+	if (argc == 2) {
+		f = fopen(argv[1], "r");
+		if (f == NULL) {
+			perror("fopen");
+			exit(1);
+		}
+	}
+
+	if (fread(&fhdr, sizeof(fhdr), 1, f) != 1 ||
+	    memcmp(fhdr.magic, DECT_EVLOG_MAGIC, sizeof(fhdr.magic))) {
+		fprintf(stderr, "not a dectmon event log\n");
+		exit(1);
+	}
+	if (fhdr.version != DECT_EVLOG_VERSION) {
+		fprintf(stderr, "unsupported event log version %u\n",
+			fhdr.version);
+		exit(1);
+	}
+
+	while (fread(&hdr, sizeof(hdr), 1, f) == 1) {
+		if (hdr.len && fread(buf, hdr.len, 1, f) != 1) {
+			fprintf(stderr, "truncated record\n");
+			break;
+		}
+
+		switch (hdr.type) {
+		case DECT_EV_CLUSTER:
+			evlog_cluster(&hdr, (char *)buf);
+			break;
+		case DECT_EV_MAC:
+			if (hdr.len >= sizeof(struct dect_ev_mac))
+				evlog_print_mac(&hdr, (void *)buf);
+			break;
+		case DECT_EV_BEARER:
+			if (hdr.len >= sizeof(struct dect_ev_bearer))
+				evlog_print_bearer(&hdr, (void *)buf);
+			break;
+		case DECT_EV_NWK:
+			if (hdr.len >= sizeof(struct dect_ev_nwk))
+				evlog_print_nwk(&hdr, (void *)buf);
+			break;
+		case DECT_EV_CDR:
+			if (hdr.len >= sizeof(struct dect_cdr))
+				evlog_print_cdr(&hdr, (void *)buf);
+			break;
+		default:
+			break;
+		}
+	}
+
+	fclose(f);
+	return 0;
+}
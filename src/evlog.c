@@ -0,0 +1,217 @@
+/*
+ * dectmon binary event log
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <dect/libdect.h>
+#include <dectmon.h>
+#include <evlog.h>
+#include <cdr.h>
+
+#define EVLOG_BUFSIZE		65536
+#define EVLOG_FLUSH_INTERVAL	1
+
+int dect_evlog_fd = -1;
+static pthread_mutex_t evlog_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t evlog_buf[EVLOG_BUFSIZE];
+static unsigned int evlog_len;
+static off_t evlog_size;
+static struct event evlog_timer;
+static bool evlog_timer_active;
+
+/* Position of the frame currently being processed by this thread */
+static __thread uint32_t evlog_frame;
+static __thread uint8_t evlog_slot;
+
+/*
+ * Called with evlog_lock held. The buffer only contains complete records,
+ * on write errors the file is truncated to the last complete record and
+ * logging is stopped so no partial record is ever followed by others.
+ */
+static void dect_evlog_flush(void)
+{
+	unsigned int off = 0;
+	ssize_t ret;
+
+	if (dect_evlog_fd < 0)
+		goto out;
+
+	while (off < evlog_len) {
+		ret = write(dect_evlog_fd, evlog_buf + off, evlog_len - off);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			goto err;
+		}
+		off += ret;
+	}
+	evlog_size += off;
+out:
+	evlog_len = 0;
+	return;
+
+err:
+	dectmon_log("evlog: write failed, logging stopped: %s\n",
+		    strerror(errno));
+	if (ftruncate(dect_evlog_fd, evlog_size) < 0)
+		dectmon_log("evlog: truncate failed: %s\n", strerror(errno));
+	close(dect_evlog_fd);
+	dect_evlog_fd = -1;
+	goto out;
+}
+
+/* Called with evlog_lock held, the record must be filled before unlocking */
+static void *dect_evlog_reserve(enum dect_evlog_types type, uint8_t cluster,
+				unsigned int len)
+{
+	struct dect_evlog_hdr *hdr;
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+
+	if (evlog_len + sizeof(*hdr) + len > sizeof(evlog_buf))
+		dect_evlog_flush();
+
+	hdr = (void *)evlog_buf + evlog_len;
+	hdr->type    = type;
+	hdr->cluster = cluster;
+	hdr->len     = len;
+	hdr->frame   = evlog_frame;
+	hdr->tstamp  = tv.tv_sec * 1000000ULL + tv.tv_usec;
+
+	evlog_len += sizeof(*hdr) + len;
+	return hdr + 1;
+}
+
+void __dect_evlog_cluster(uint8_t cluster, const char *name)
+{
+	unsigned int len;
+
+	if (name == NULL)
+		name = "";
+	len = strlen(name);
+
+	pthread_mutex_lock(&evlog_lock);
+	memcpy(dect_evlog_reserve(DECT_EV_CLUSTER, cluster, len), name, len);
+	pthread_mutex_unlock(&evlog_lock);
+}
+
+void __dect_evlog_mac(uint8_t cluster, const struct dect_msg_buf *mb)
+{
+	struct dect_ev_mac *ev;
+
+	evlog_frame = DECT_EV_FRAME(mb->mfn, mb->frame);
+	evlog_slot  = mb->slot;
+
+	pthread_mutex_lock(&evlog_lock);
+	ev = dect_evlog_reserve(DECT_EV_MAC, cluster, sizeof(*ev));
+	ev->slot = mb->slot;
+	memcpy(ev->data, mb->data, sizeof(ev->data));
+	pthread_mutex_unlock(&evlog_lock);
+}
+
+void __dect_evlog_bearer(uint8_t cluster, enum dect_ev_bearer_events event,
+			 const struct dect_tbc *tbc)
+{
+	struct dect_ev_bearer *ev;
+
+	pthread_mutex_lock(&evlog_lock);
+	ev = dect_evlog_reserve(DECT_EV_BEARER, cluster, sizeof(*ev));
+	ev->event    = event;
+	ev->slot1    = tbc->slot1;
+	ev->slot2    = tbc->slot2;
+	ev->ciphered = tbc->ciphered;
+	ev->pmid     = tbc->pmid;
+	ev->fmid     = tbc->fmid;
+	pthread_mutex_unlock(&evlog_lock);
+}
+
+void __dect_evlog_nwk(uint8_t cluster, const struct dect_tbc *tbc,
+		      const struct dect_msg_buf *mb)
+{
+	struct dect_ev_nwk *ev;
+
+	pthread_mutex_lock(&evlog_lock);
+	ev = dect_evlog_reserve(DECT_EV_NWK, cluster, sizeof(*ev) + mb->len);
+	ev->pmid = tbc->pmid;
+	ev->slot = evlog_slot;
+	memcpy(ev->data, mb->data, mb->len);
+	pthread_mutex_unlock(&evlog_lock);
+}
+
+void __dect_evlog_cdr(uint8_t cluster, const struct dect_cdr *cdr)
+{
+	pthread_mutex_lock(&evlog_lock);
+	memcpy(dect_evlog_reserve(DECT_EV_CDR, cluster, sizeof(*cdr)),
+	       cdr, sizeof(*cdr));
+	pthread_mutex_unlock(&evlog_lock);
+}
+
+int dect_evlog_open(const char *name)
+{
+	struct dect_evlog_file_hdr hdr;
+
+	dect_evlog_fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (dect_evlog_fd < 0)
+		return -1;
+
+	memcpy(hdr.magic, DECT_EVLOG_MAGIC, sizeof(hdr.magic));
+	hdr.version = DECT_EVLOG_VERSION;
+	memcpy(evlog_buf, &hdr, sizeof(hdr));
+	evlog_len = sizeof(hdr);
+	evlog_size = 0;
+	return 0;
+}
+
+static void dect_evlog_timer(int fd, short event, void *data)
+{
+	struct timeval tv = { .tv_sec = EVLOG_FLUSH_INTERVAL };
+
+	pthread_mutex_lock(&evlog_lock);
+	dect_evlog_flush();
+	pthread_mutex_unlock(&evlog_lock);
+
+	if (dect_evlog_fd >= 0)
+		evtimer_add(&evlog_timer, &tv);
+}
+
+/* Start the periodic flush, called from the main thread's event loop */
+void dect_evlog_init(void)
+{
+	struct timeval tv = { .tv_sec = EVLOG_FLUSH_INTERVAL };
+
+	if (dect_evlog_fd < 0)
+		return;
+	evtimer_set(&evlog_timer, dect_evlog_timer, NULL);
+	evtimer_add(&evlog_timer, &tv);
+	evlog_timer_active = true;
+}
+
+void dect_evlog_close(void)
+{
+	if (evlog_timer_active) {
+		evtimer_del(&evlog_timer);
+		evlog_timer_active = false;
+	}
+	pthread_mutex_lock(&evlog_lock);
+	dect_evlog_flush();
+	if (dect_evlog_fd >= 0) {
+		close(dect_evlog_fd);
+		dect_evlog_fd = -1;
+	}
+	pthread_mutex_unlock(&evlog_lock);
+}
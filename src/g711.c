@@ -0,0 +1,83 @@
+/*
+ * dectmon G.711 block conversion
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Derived from the Sun Microsystems CCITT ADPCM reference implementation
+ * in ccitt-adpcm/, which is provided for unrestricted use, see the notice
+ * in ccitt-adpcm/g72x.c.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include <utils.h>
+#include <g711.h>
+#include "ccitt-adpcm/g72x.h"
+
+/*
+ * The reference encoders don't only depend on the upper bits of negative
+ * samples, so the encoder tables cover the full sample range (64 kB each).
+ */
+static uint8_t g711_alaw_enc[65536];
+static uint8_t g711_ulaw_enc[65536];
+static int16_t g711_alaw_dec[256];
+static int16_t g711_ulaw_dec[256];
+
+static pthread_once_t g711_once = PTHREAD_ONCE_INIT;
+
+static void dect_g711_build(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < array_size(g711_alaw_enc); i++) {
+		g711_alaw_enc[i] = linear2alaw((int16_t)i);
+		g711_ulaw_enc[i] = linear2ulaw((int16_t)i);
+	}
+	for (i = 0; i < array_size(g711_alaw_dec); i++) {
+		g711_alaw_dec[i] = alaw2linear(i);
+		g711_ulaw_dec[i] = ulaw2linear(i);
+	}
+}
+
+void dect_g711_init(void)
+{
+	pthread_once(&g711_once, dect_g711_build);
+}
+
+void dect_alaw_encode(uint8_t *dst, const int16_t *src, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = g711_alaw_enc[(uint16_t)src[i]];
+}
+
+void dect_alaw_decode(int16_t *dst, const uint8_t *src, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = g711_alaw_dec[src[i]];
+}
+
+void dect_ulaw_encode(uint8_t *dst, const int16_t *src, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = g711_ulaw_enc[(uint16_t)src[i]];
+}
+
+void dect_ulaw_decode(int16_t *dst, const uint8_t *src, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = g711_ulaw_dec[src[i]];
+}
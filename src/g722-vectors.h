@@ -0,0 +1,344 @@
+#ifndef _DECTMON_G722_VECTORS_H
+#define _DECTMON_G722_VECTORS_H
+
+/*
+ * G.722 decoder reference vectors
+ *
+ * Generated with a standalone per-block transcription of the G.722 decoder
+ * (saturating 16 bit operators as in the ITU-T software tools library),
+ * starting from the reset state. The code words of the first two vectors
+ * were produced by encoding a two tone signal and a full scale square wave,
+ * the last one contains random code words including the lower sub-band
+ * codes 0-3, which are not produced by the encoder.
+ */
+
+#define G722_VECTOR_CODES	240
+
+struct g722_vector {
+	const char	*name;
+	uint8_t		code[G722_VECTOR_CODES];
+	int16_t		pcm[2 * G722_VECTOR_CODES];
+};
+
+static const struct g722_vector g722_vectors[] = {
+	{
+		.name	= "tones",
+		.code	= {
+			0xfa, 0x14, 0xf2, 0xa0, 0x04, 0xa0, 0xa0, 0x20,
+			0xa5, 0xb5, 0x0f, 0x8b, 0x13, 0x1e, 0xb1, 0x2c,
+			0xb0, 0xba, 0x15, 0x91, 0x16, 0x1f, 0xb2, 0x2e,
+			0xb3, 0xbc, 0x17, 0x94, 0x56, 0x1f, 0xb3, 0x6f,
+			0xf4, 0xfb, 0x17, 0x95, 0xd8, 0x5f, 0xb3, 0x70,
+			0xf3, 0xfd, 0x18, 0xd3, 0x59, 0x1f, 0xb3, 0x71,
+			0xf4, 0xfb, 0x17, 0xd5, 0x58, 0x1f, 0xf2, 0x30,
+			0x74, 0xfb, 0x16, 0xd4, 0x58, 0x5f, 0xb2, 0x70,
+			0xf3, 0xbf, 0x57, 0x95, 0xd8, 0x5e, 0xb3, 0x70,
+			0xf3, 0xfd, 0x18, 0xd3, 0x5c, 0x1c, 0xf2, 0x30,
+			0x73, 0xfb, 0x56, 0x96, 0xda, 0x7e, 0xb4, 0x6f,
+			0xf6, 0xf9, 0x16, 0xd6, 0x5a, 0x1e, 0xf2, 0x31,
+			0x74, 0xf9, 0x16, 0xd5, 0x58, 0x5c, 0xb2, 0x70,
+			0xf4, 0xb8, 0x56, 0x94, 0xd7, 0x7e, 0xf5, 0x30,
+			0x75, 0xf8, 0x15, 0xd3, 0x5b, 0x5c, 0xb5, 0x71,
+			0xf6, 0xb8, 0x55, 0x93, 0x5b, 0x5b, 0xb4, 0xf2,
+			0xf9, 0xf7, 0x12, 0x97, 0xd8, 0x58, 0xf6, 0x73,
+			0xf7, 0xba, 0x15, 0x96, 0xd9, 0xd8, 0xf4, 0x70,
+			0xf6, 0xb9, 0x15, 0xd5, 0x19, 0x57, 0xf1, 0xf5,
+			0xf6, 0xba, 0x15, 0xd5, 0x17, 0x5a, 0xf5, 0xf5,
+			0xf8, 0xb6, 0x52, 0x96, 0x56, 0x57, 0xf5, 0x7a,
+			0xfb, 0xbc, 0x54, 0x90, 0x53, 0x59, 0xfd, 0x3a,
+			0x5d, 0xf9, 0x0f, 0xd2, 0x52, 0xd3, 0xbb, 0x18,
+			0x5c, 0xdd, 0x50, 0x8e, 0xd5, 0xd2, 0xbd, 0x5a,
+			0xdf, 0xdf, 0x10, 0x8f, 0xda, 0xd2, 0xfd, 0x1c,
+			0x7e, 0xfe, 0x10, 0xd5, 0x16, 0x56, 0xfb, 0x5f,
+			0x77, 0x9f, 0x57, 0x95, 0x16, 0x56, 0xf8, 0x79,
+			0x3c, 0x77, 0x12, 0x9a, 0x55, 0xd6, 0xf7, 0xfc,
+			0x76, 0xfa, 0x15, 0x96, 0x5a, 0x55, 0xf8, 0x75,
+			0xf9, 0xf5, 0x13, 0x9e, 0xd5, 0xd4, 0xf7, 0x36,
+		},
+		.pcm	= {
+			0, -1, -1, 0, 0, -1, 0,
+			0, -1, -1, 1, 0, -1, -2,
+			-8, -31, 23, 91, -12, -185, -81,
+			249, 555, 890, 1477, 2455, 3782, 4669,
+			4349, 2685, 232, -2286, -4414, -5874, -6070,
+			-5131, -3740, -2425, -298, 2146, 4250, 5702,
+			6201, 5359, 3868, 2659, 195, -2603, -4465,
+			-5816, -6375, -5238, -3269, -2976, -243, 2802,
+			4036, 5408, 6947, 5493, 2532, 4000, 72,
+			-4086, -3305, -4319, -8098, -4848, -2297, -5360,
+			385, 4969, 1636, 5559, 8318, 4782, 2568,
+			4445, 542, -5211, -2568, -3726, -9631, -3636,
+			-2461, -4505, -356, 5316, 1562, 4931, 8588,
+			4721, 2319, 4221, 457, -4882, -2044, -5233,
+			-8448, -4693, -2114, -5748, 322, 5624, 1021,
+			4988, 8835, 4547, 2256, 4736, 369, -5505,
+			-1413, -4732, -8574, -4436, -1676, -5628, 739,
+			4458, 2719, 3903, 9732, 3721, 2251, 5055,
+			97, -5669, -1450, -4717, -8920, -4592, -1846,
+			-4656, -581, 5324, 1829, 4529, 8840, 4697,
+			1808, 5550, -612, -4716, -2540, -3848, -9676,
+			-4054, -2322, -5242, -102, 5681, 1400, 4536,
+			9183, 4712, 1961, 4806, 560, -5384, -1880,
+			-4565, -9062, -4523, -1626, -5682, 348, 4871,
+			2562, 3955, 9682, 4072, 2175, 5069, -243,
+			-4562, -2782, -3896, -9066, -4520, -2154, -4811,
+			-205, 5273, 2117, 4404, 8730, 4615, 2032,
+			4664, 398, -5291, -2212, -4442, -8739, -4583,
+			-1899, -5298, 325, 4718, 2399, 4101, 9205,
+			4052, 2277, 5176, -21, -5488, -1586, -4436,
+			-8972, -4429, -2075, -4936, -365, 5186, 2045,
+			4513, 9013, 4426, 1801, 5374, -341, -4891,
+			-2267, -4234, -9389, -4161, -2311, -5109, 419,
+			4551, 2452, 4298, 8875, 4363, 2209, 4892,
+			173, -5025, -2106, -4487, -8700, -4479, -2238,
+			-4769, -104, 5063, 2147, 4618, 8879, 4371,
+			2077, 5293, -320, -4793, -2228, -4227, -8897,
+			-4726, -1972, -4819, -351, 5345, 1767, 4726,
+			8907, 4414, 2394, 4764, 253, -4918, -2436,
+			-3970, -9230, -4282, -2186, -5115, 300, 4760,
+			2032, 4814, 8686, 4197, 2398, 5349, -353,
+			-5185, -1952, -4020, -9571, -4059, -2206, -5340,
+			243, 5027, 1987, 4628, 8916, 4543, 2023,
+			5098, 60, -5112, -1993, -4639, -8633, -5032,
+			-1801, -4737, -485, 5249, 2158, 4438, 8711,
+			4627, 2017, 4924, 290, -5360, -1833, -4720,
+			-8727, -4750, -1988, -5023, -248, 5440, 1910,
+			4439, 8946, 4662, 1985, 4971, -29, -4554,
+			-2424, -4666, -8563, -4317, -2403, -5143, 208,
+			4969, 2073, 4575, 8834, 4669, 2005, 5039,
+			-184, -4687, -2362, -4649, -8641, -4499, -2392,
+			-4947, 151, 4803, 2391, 4111, 8984, 4687,
+			1919, 4875, 253, -5205, -2087, -4592, -9055,
+			-4155, -2481, -5058, 29, 4985, 2412, 4076,
+			9247, 4510, 1880, 5092, 81, -4936, -2229,
+			-4069, -9135, -4193, -2145, -4977, 118, 4904,
+			2102, 4706, 8665, 4214, 2475, 4834, -78,
+			-4982, -2390, -4069, -9269, -4360, -1982, -5018,
+			22, 4946, 2395, 4160, 9122, 4427, 2036,
+			5089, 10, -5238, -2151, -4461, -8627, -4723,
+			-1975, -4783, -349, 4835, 2453, 4426, 8767,
+			4384, 2164, 5133, -301, -4751, -2186, -4917,
+			-8472, -4699, -2361, -4770, -246, 4921, 2495,
+			4232, 9040, 4211, 2387, 4927, 19, -5034,
+			-2270, -4117, -9137, -4486, -2053, -5140, -83,
+			5239, 2016, 4219, 9203, 4432, 2054, 4760,
+			81, -4648, -2566, -4693, -8698, -4300, -2309,
+			-5205, 248, 5274, 1944, 4312, 9220, 4530,
+			2023, 4975, 183, -5019,
+		},
+	},
+	{
+		.name	= "square",
+		.code	= {
+			0x23, 0x84, 0x20, 0x84, 0x20, 0x84, 0x04, 0x84,
+			0x04, 0x84, 0x84, 0x04, 0x84, 0x04, 0x84, 0x29,
+			0xa0, 0x20, 0xa0, 0x60, 0x60, 0xa1, 0x21, 0xa3,
+			0x20, 0x87, 0x04, 0xc4, 0x44, 0x46, 0xc7, 0x47,
+			0x87, 0x0b, 0x86, 0x22, 0xa0, 0xe1, 0x62, 0x66,
+			0x66, 0xe4, 0x64, 0xa6, 0x22, 0x85, 0x44, 0xc5,
+			0xc9, 0x4d, 0x4b, 0x4a, 0x89, 0x0d, 0x86, 0x20,
+			0xe0, 0xe3, 0x6a, 0x6c, 0x68, 0xe5, 0x65, 0xaa,
+			0x23, 0x84, 0x44, 0x49, 0xce, 0xd1, 0xce, 0x4a,
+			0xca, 0x11, 0x87, 0x20, 0xe0, 0xe9, 0x6c, 0x6c,
+			0x69, 0xe5, 0x67, 0xb0, 0x23, 0x84, 0x44, 0x54,
+			0x50, 0x50, 0x4d, 0x4a, 0x8c, 0x14, 0x87, 0x20,
+			0xe0, 0xfb, 0x6c, 0x6c, 0x6a, 0x66, 0x29, 0xb4,
+			0x23, 0x84, 0xc4, 0x71, 0x4e, 0xd1, 0xcf, 0xcb,
+			0x8e, 0x5c, 0x86, 0x20, 0xe0, 0xcf, 0x67, 0x70,
+			0x6a, 0x67, 0x2b, 0xbb, 0x22, 0x84, 0xc4, 0x67,
+			0x49, 0x55, 0x4e, 0x4b, 0xd0, 0x1e, 0x86, 0x20,
+			0x60, 0xc8, 0xe7, 0x70, 0x6a, 0xe7, 0x2c, 0xff,
+			0x22, 0x84, 0x44, 0x62, 0xc6, 0xdd, 0xcc, 0x4a,
+			0xd1, 0x3c, 0x86, 0x20, 0xe0, 0xc6, 0x62, 0x79,
+			0x67, 0x6a, 0x2b, 0x9c, 0x22, 0x84, 0xc4, 0x63,
+			0x46, 0x5c, 0x4a, 0x4f, 0x8f, 0x7a, 0x86, 0x20,
+			0xe0, 0xc7, 0x62, 0x78, 0x64, 0xeb, 0x2b, 0xdf,
+			0x22, 0x84, 0x44, 0x64, 0xd1, 0xce, 0xca, 0x4f,
+			0x92, 0x3e, 0x86, 0x20, 0x60, 0xc8, 0x6d, 0x6a,
+			0xe5, 0xec, 0x2b, 0xbe, 0x22, 0x84, 0x84, 0xe4,
+			0x51, 0x4f, 0x49, 0x50, 0xce, 0x3b, 0x86, 0x20,
+			0x20, 0x48, 0xee, 0xea, 0xe4, 0xeb, 0x70, 0xb9,
+			0x62, 0x84, 0xc4, 0x64, 0x51, 0x50, 0x47, 0x56,
+			0x92, 0x79, 0x85, 0x20, 0x60, 0xc7, 0x63, 0x78,
+		},
+		.pcm	= {
+			0, -1, -1, 0, 0, -4, -2,
+			14, 3, -52, 1, 180, -11, -433,
+			39, 856, -74, -1607, -196, 2816, 1932,
+			-4139, -11544, -17437, -21439, -23667, -24496, -24798,
+			-25080, -25586, -26190, -26734, -27314, -27703, -28524,
+			-29877, -29711, -29328, -32657, -32768, -27490, -8890,
+			7970, 16394, 20371, 23725, 26699, 28421, 29300,
+			31049, 32634, 32767, 32394, 32076, 32235, 32767,
+			32235, 29508, 30755, 32767, 28519, 9481, -9351,
+			-17147, -19247, -26319, -32459, -32768, -31513, -32768,
+			-32768, -32618, -32488, -32768, -32768, -32577, -32302,
+			-30701, -30482, -32768, -29503, -12230, 8991, 18139,
+			17783, 26579, 32767, 32378, 31733, 32282, 32767,
+			32317, 32599, 32767, 32691, 32767, 32234, 31272,
+			31123, 32767, 29417, 11838, -10372, -17682, -19934,
+			-28555, -32768, -32768, -30635, -32768, -32768, -32768,
+			-31905, -32401, -32416, -31696, -32660, -32044, -30506,
+			-32279, -29973, -12425, 12177, 19554, 19002, 27486,
+			32767, 32612, 31339, 32547, 32767, 32303, 32450,
+			32767, 32393, 32566, 32348, 31787, 31139, 32375,
+			29963, 14166, -9299, -19078, -20422, -27658, -32768,
+			-32719, -31511, -32553, -32768, -32375, -32146, -32581,
+			-31973, -32525, -32417, -31611, -31020, -32296, -30138,
+			-15289, 8258, 20236, 22600, 28344, 32767, 32578,
+			31762, 32611, 32767, 32351, 32565, 32767, 32583,
+			32685, 32355, 31491, 31060, 32179, 30318, 16397,
+			-7198, -21302, -24548, -28776, -32628, -32768, -31532,
+			-32594, -32768, -32762, -32221, -32693, -32688, -31938,
+			-32428, -32104, -30322, -31012, -31232, -18389, 7492,
+			23118, 25223, 29121, 32767, 32459, 31709, 32712,
+			32767, 32097, 32512, 32767, 32767, 31722, 32488,
+			32744, 30326, 30331, 31740, 19695, -8388, -24201,
+			-27017, -30023, -32392, -32680, -31981, -32450, -32768,
+			-32578, -32440, -32490, -32740, -31964, -32620, -31686,
+			-30693, -30966, -31059, -19584, 7403, 26172, 29004,
+			30328, 32767, 32241, 32154, 32627, 32767, 32349,
+			32719, 32767, 32714, 31631, 32438, 32767, 30151,
+			29790, 32161, 21176, -8140, -26277, -29152, -30369,
+			-31827, -32489, -31916, -32709, -32467, -32595, -32554,
+			-32506, -32109, -32335, -32244, -32164, -30656, -30322,
+			-31674, -20942, 7322, 27218, 31054, 30279, 30597,
+			32312, 32639, 32442, 32767, 32568, 32424, 32767,
+			32767, 31742, 32752, 32001, 30313, 30541, 31603,
+			20981, -7285, -29504, -32426, -29993, -30640, -31755,
+			-32768, -32768, -32768, -32545, -32619, -32476, -31825,
+			-32282, -32482, -31979, -30569, -30714, -31428, -20717,
+			7027, 29386, 32476, 29515, 30250, 31904, 32695,
+			32569, 32651, 32427, 32767, 32668, 32641, 31969,
+			32321, 32421, 30228, 30139, 31858, 20831, -8392,
+			-29093, -32472, -31256, -31446, -32350, -32269, -32768,
+			-32557, -32235, -32274, -32768, -32768, -31938, -32664,
+			-31978, -30658, -30795, -31312, -20259, 7666, 29705,
+			32507, 29914, 31113, 32125, 32412, 32537, 32767,
+			32437, 32550, 32767, 32767, 31891, 32767, 31847,
+			30382, 31038, 31273, 19792, -7623, -29399, -32768,
+			-30869, -31896, -32468, -32211, -32354, -32768, -32375,
+			-32469, -32768, -32768, -31771, -32481, -32620, -30189,
+			-30270, -31657, -19529, 10103, 29814, 31805, 31136,
+			32405, 31996, 32252, 32767, 32432, 32503, 32722,
+			32767, 32671, 31702, 32408, 32767, 30161, 29708,
+			32152, 20595, -10344, -28482, -32414, -31245, -30797,
+			-32386, -32396, -32768, -32340, -32768, -32567, -32625,
+			-32294, -32217, -32036, -32657, -30751, -29526, -31876,
+			-20712, 10908, 28669, 32252, 31023, 31040, 32658,
+			32071, 32767, 32767, 32767, 32270, 32627, 32604,
+			32268, 31987, 32462, 30218, 30692, 31346, 19252,
+			-9582, -29643, -32102, -30822, -31194, -32461, -32145,
+			-32678, -32446, -32684, -32576, -32768, -32768, -31870,
+			-32675, -31928, -30759, -31036,
+		},
+	},
+	{
+		.name	= "random",
+		.code	= {
+			0x41, 0x96, 0x27, 0xc4, 0xf9, 0x95, 0xd9, 0x9c,
+			0xbf, 0x0f, 0x0a, 0x31, 0x23, 0xaf, 0x7d, 0xc4,
+			0xe2, 0xd2, 0xe2, 0xe3, 0xe9, 0x93, 0x50, 0x28,
+			0x2c, 0x75, 0x42, 0xb3, 0x4d, 0xe4, 0xf7, 0xef,
+			0xee, 0x56, 0xe1, 0xca, 0x31, 0xad, 0x99, 0x69,
+			0xb5, 0x3b, 0x7d, 0x10, 0x1b, 0x7a, 0xde, 0xb4,
+			0xe3, 0x61, 0x7a, 0x83, 0x28, 0xe0, 0x9f, 0x4b,
+			0x85, 0xfa, 0x28, 0x87, 0x38, 0x75, 0x49, 0x8f,
+			0x48, 0x20, 0xbf, 0x1e, 0x3d, 0x33, 0xef, 0x36,
+			0xad, 0x30, 0x05, 0x14, 0xc2, 0x59, 0x0c, 0xb3,
+			0x62, 0x9f, 0xab, 0x1d, 0xa6, 0xa6, 0xf1, 0x84,
+			0xd3, 0x33, 0x56, 0xdd, 0xf8, 0x1d, 0xeb, 0x7b,
+			0xe3, 0xb7, 0x56, 0xe7, 0x14, 0x23, 0x11, 0xee,
+			0xe0, 0x1a, 0x11, 0xa5, 0xe6, 0x1c, 0xc8, 0xdb,
+			0x99, 0xfe, 0x20, 0x37, 0x60, 0x6e, 0xf2, 0xfd,
+			0xb2, 0xb7, 0x10, 0x3a, 0x1e, 0xfe, 0xd3, 0xcd,
+			0x1e, 0xba, 0xe5, 0x8a, 0x3c, 0x13, 0x9f, 0x78,
+			0xce, 0x7e, 0x3d, 0xe6, 0x5f, 0xb0, 0xbd, 0xc3,
+			0x8c, 0xcc, 0x2c, 0x92, 0xe3, 0x5b, 0xb9, 0xda,
+			0x0c, 0x7b, 0xc6, 0xde, 0x4a, 0x51, 0xe4, 0x18,
+			0x26, 0xa4, 0x57, 0xa5, 0xc8, 0x35, 0xa7, 0xb8,
+			0x48, 0x3e, 0x4d, 0xb5, 0x10, 0x20, 0x84, 0x7d,
+			0x0e, 0x30, 0xd2, 0x2c, 0x46, 0x2d, 0xc8, 0x3c,
+			0x14, 0xce, 0x16, 0xc7, 0x25, 0x6f, 0xea, 0x6c,
+			0xf2, 0xcc, 0x45, 0x15, 0x53, 0x58, 0xa1, 0x8d,
+			0x68, 0x98, 0x36, 0xad, 0xeb, 0x91, 0xa1, 0x96,
+			0xbd, 0x30, 0xc0, 0x40, 0x2d, 0x43, 0x0f, 0x42,
+			0x4d, 0x5d, 0xc7, 0xac, 0x66, 0xcb, 0xa2, 0x55,
+			0x46, 0x64, 0xf1, 0xf1, 0x08, 0xe6, 0x74, 0xd2,
+			0x95, 0x26, 0x15, 0x24, 0xeb, 0x44, 0x84, 0x1a,
+		},
+		.pcm	= {
+			0, 0, -1, -1, 0, 0, -1,
+			0, 0, -2, 0, 1, -5, -17,
+			1, 27, 8, -77, -77, -8, 23,
+			-37, -60, -35, -8, -22, -27, -10,
+			-7, -57, -89, -148, -74, -47, 135,
+			238, 284, 45, 220, 586, -386, -1755,
+			-337, 2457, 1685, -1758, -1540, 3865, 10133,
+			14098, 14839, 11667, 5731, -942, -7225, -9573,
+			-3489, 7070, 11902, 8510, 5074, 4475, 1812,
+			-2413, 76, 5603, 395, -10097, -4795, 12553,
+			16314, 4571, -1855, 2645, 8675, 9552, 1047,
+			-8092, 2406, 23168, 18749, -7695, -15611, 1335,
+			12782, 7688, -491, -2956, 1436, 9001, 10022,
+			3221, -1315, 381, 2691, 1664, -1699, -5403,
+			-5599, -2498, 733, 1155, 420, -685, -510,
+			1757, 4259, 7967, 15316, 22041, 17678, 4512,
+			-2447, 544, 2695, 3469, 13333, 26264, 23889,
+			7571, -3119, -4786, -11429, -21490, -21261, -8249,
+			6735, 12952, 3956, -12219, -15843, -4443, 5191,
+			3276, -4337, -11699, -10026, -3628, -10186, -21597,
+			-9198, 19861, 27244, 7595, -6452, -2690, 2145,
+			-1080, -775, 67, 4892, 7033, 5746, 1070,
+			1121, 3617, 6494, 8299, 1073, -17471, -18755,
+			-12349, -269, -1279, -1562, -445, -1934, -10561,
+			-8914, -2384, 5031, 20468, 19899, 6400, -4322,
+			11220, 5603, -4853, 3051, 13077, 6699, 19677,
+			8812, 10005, -4727, -14772, -32768, -9012, 636,
+			-2146, 8238, -3611, -4463, -4138, -1166, 1879,
+			1777, -6247, 5288, 9226, 3029, -509, 5134,
+			11258, 13280, 13996, -4354, -7905, 1392, 13517,
+			7334, -8613, 2298, 11051, 21048, -8454, -6917,
+			-1434, 12517, 26667, 21169, 18, -2136, -14798,
+			1789, 14184, 4564, 17174, 14427, -4169, -2831,
+			-13743, -20111, -4499, 623, 5113, -7840, -3346,
+			5319, 16231, 25413, -3965, 8640, 19933, 27151,
+			9679, 5114, 5083, 3768, 3730, -2492, 4067,
+			-3232, 11401, -3293, -11377, 643, -8940, 7237,
+			-9628, 4559, -1915, -2122, -2363, -8245, -5898,
+			-8946, -5606, 954, 2388, -3766, 14930, 7655,
+			-2406, -17343, -5045, 12146, -14065, -2607, 3211,
+			-5125, 2595, 2456, -8873, -11249, 1435, 3729,
+			-7853, 5289, 11796, 8614, -76, -59, 7309,
+			-463, 8849, -4673, 1692, -2109, 599, -18109,
+			-10302, -3201, -694, 9722, -3520, -12483, 18071,
+			20497, -3554, -7520, 7240, -40, 4679, -3419,
+			-17701, 653, 2850, -2838, -19609, -20563, -817,
+			3888, -9600, -16814, -12182, 3560, 17028, 10431,
+			-5857, -214, 3738, 22171, 23425, -638, -5832,
+			5046, 21929, 4348, -11114, -19697, -6318, 20356,
+			13335, -9873, 9765, -6773, -15316, -4122, -6091,
+			2902, -12464, -8378, 14427, -1067, -21794, 8472,
+			19200, 21475, -15276, -32768, 5389, 21428, -19299,
+			-8540, 3887, 13252, -7387, -11519, 7739, 13600,
+			-26370, -18224, 13085, 18533, -20373, -27692, 5219,
+			23859, -16766, -13985, -1566, 311, -2602, -3316,
+			-20391, -11022, 16125, 26735, -5979, -9198, 16121,
+			15223, 1608, 1637, 7528, 3729, -2891, -16714,
+			-21419, -13618, -8460, 473, -6847, -11240, -8753,
+			7049, 24426, 9567, -6177, -10355, 16541, 21323,
+			-2960, -17836, 2830, 20245, 2699, -11400, 15008,
+			7215, -11808, -9520, 32767, 16040, -6818, -22150,
+			15808, 11280, -10021, 516, 1847, 312, -952,
+			1223, -4909, 11959, 1108, -5281, -11880, 4204,
+			956, -1984, -12091, -6591, 3757, 531, -19371,
+			-18654, 15728, 19511, 10101, -5966, -13118, -260,
+			29642, 16710, -8857, -19724, -14532, 4562, 14048,
+			9477, -4452, -2284, 13732, 3843, -25624, -12995,
+			19599, 22581, -3818, -14171, -557, 1660, -7235,
+			-5792, 14293, 17079, -13883,
+		},
+	},
+};
+
+#endif /* _DECTMON_G722_VECTORS_H */
@@ -0,0 +1,255 @@
+/*
+ * dectmon G.722 decoder
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Derived from the SpanDSP G.722 decoder (g722_decode.c), which carries
+ * the following notice:
+ *
+ *   Written by Steve Underwood <steveu@coppice.org>
+ *
+ *   Copyright (C) 2005 Steve Underwood
+ *
+ *   Despite my general liking of the GPL, I place my own contributions
+ *   to this code in the public domain for the benefit of all mankind -
+ *   even the slimy ones who might try to proprietize my work and use it
+ *   to my detriment.
+ *
+ *   Based on a single channel G.722 codec which is:
+ *
+ *   *****    Copyright (c) CMU    1993      *****
+ *   Computer Science, Speech Group
+ *   Chengxiang Lu and Alex Hauptmann
+ *
+ * Block names refer to the ITU-T G.722 recommendation.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <g722.h>
+
+static const int g722_wl[8] = {
+	-60, -30, 58, 172, 334, 538, 1198, 3042,
+};
+
+static const int g722_rl42[16] = {
+	0, 7, 6, 5, 4, 3, 2, 1, 7, 6, 5, 4, 3, 2, 1, 0,
+};
+
+static const int g722_ilb[32] = {
+	2048, 2093, 2139, 2186, 2233, 2282, 2332, 2383,
+	2435, 2489, 2543, 2599, 2656, 2714, 2774, 2834,
+	2896, 2960, 3025, 3091, 3158, 3228, 3298, 3371,
+	3444, 3520, 3597, 3676, 3756, 3838, 3922, 4008,
+};
+
+static const int g722_wh[3] = {
+	0, -214, 798,
+};
+
+static const int g722_rh2[4] = {
+	2, 1, 2, 1,
+};
+
+static const int g722_qm2[4] = {
+	-7408, -1616, 7408, 1616,
+};
+
+static const int g722_qm4[16] = {
+	0, -20456, -12896, -8968, -6288, -4240, -2584, -1200,
+	20456, 12896, 8968, 6288, 4240, 2584, 1200, 0,
+};
+
+static const int g722_qm6[64] = {
+	-136, -136, -136, -136, -24808, -21904, -19008, -16704,
+	-14984, -13512, -12280, -11192, -10232, -9360, -8576, -7856,
+	-7192, -6576, -6000, -5456, -4944, -4464, -4008, -3576,
+	-3168, -2776, -2400, -2032, -1688, -1360, -1040, -728,
+	24808, 21904, 19008, 16704, 14984, 13512, 12280, 11192,
+	10232, 9360, 8576, 7856, 7192, 6576, 6000, 5456,
+	4944, 4464, 4008, 3576, 3168, 2776, 2400, 2032,
+	1688, 1360, 1040, 728, 432, 136, -432, -136,
+};
+
+static const int g722_qmf_coeffs[12] = {
+	3, -11, 12, 32, -210, 951, 3876, -805, 362, -156, 53, -11,
+};
+
+static inline int g722_saturate(int amp)
+{
+	if (amp > INT16_MAX)
+		return INT16_MAX;
+	if (amp < INT16_MIN)
+		return INT16_MIN;
+	return amp;
+}
+
+static inline int g722_limit(int val, int lo, int hi)
+{
+	if (val < lo)
+		return lo;
+	if (val > hi)
+		return hi;
+	return val;
+}
+
+/* SCALEL/SCALEH: scale factor from the logarithmic scale factor */
+static inline int g722_scale(int nb, int shift)
+{
+	int wd1 = (nb >> 6) & 31;
+	int wd2 = shift - (nb >> 11);
+
+	return (wd2 < 0 ? g722_ilb[wd1] << -wd2 : g722_ilb[wd1] >> wd2) << 2;
+}
+
+/* Block 4: adaptive predictor update */
+static void g722_block4(struct dect_g722_band *b, int d)
+{
+	int wd1, wd2, wd3, sg0, sg1, sg2, i;
+
+	/* RECONS, PARREC */
+	b->d[0] = d;
+	b->r[0] = g722_saturate(b->s + d);
+	b->p[0] = g722_saturate(b->sz + d);
+
+	/* UPPOL2 */
+	sg0 = b->p[0] >> 15;
+	sg1 = b->p[1] >> 15;
+	sg2 = b->p[2] >> 15;
+	wd1 = g722_saturate(b->a[1] << 2);
+	wd2 = sg0 == sg1 ? -wd1 : wd1;
+	if (wd2 > 32767)
+		wd2 = 32767;
+	wd3 = (wd2 >> 7) + (sg0 == sg2 ? 128 : -128);
+	wd3 += (b->a[2] * 32512) >> 15;
+	b->ap[2] = g722_limit(wd3, -12288, 12288);
+
+	/* UPPOL1 */
+	wd1 = sg0 == sg1 ? 192 : -192;
+	wd2 = (b->a[1] * 32640) >> 15;
+	b->ap[1] = g722_saturate(wd1 + wd2);
+	wd3 = g722_saturate(15360 - b->ap[2]);
+	b->ap[1] = g722_limit(b->ap[1], -wd3, wd3);
+
+	/* UPZERO */
+	wd1 = d == 0 ? 0 : 128;
+	sg0 = d >> 15;
+	for (i = 1; i < 7; i++) {
+		wd2 = (b->d[i] >> 15) == sg0 ? wd1 : -wd1;
+		wd3 = (b->b[i] * 32640) >> 15;
+		b->bp[i] = g722_saturate(wd2 + wd3);
+	}
+
+	/* DELAYA */
+	for (i = 6; i > 0; i--) {
+		b->d[i] = b->d[i - 1];
+		b->b[i] = b->bp[i];
+	}
+	for (i = 2; i > 0; i--) {
+		b->r[i] = b->r[i - 1];
+		b->p[i] = b->p[i - 1];
+		b->a[i] = b->ap[i];
+	}
+
+	/* FILTEP */
+	wd1 = g722_saturate(b->r[1] + b->r[1]);
+	wd1 = (b->a[1] * wd1) >> 15;
+	wd2 = g722_saturate(b->r[2] + b->r[2]);
+	wd2 = (b->a[2] * wd2) >> 15;
+	b->sp = g722_saturate(wd1 + wd2);
+
+	/* FILTEZ */
+	b->sz = 0;
+	for (i = 6; i > 0; i--) {
+		wd1 = g722_saturate(b->d[i] + b->d[i]);
+		b->sz += (b->b[i] * wd1) >> 15;
+	}
+	b->sz = g722_saturate(b->sz);
+
+	/* PREDIC */
+	b->s = g722_saturate(b->sp + b->sz);
+}
+
+static inline int g722_decode_low(struct dect_g722_band *b, unsigned int ilow)
+{
+	int rlow, dlow, wd;
+
+	/* INVQBL, RECONS, LIMIT */
+	wd   = (b->det * g722_qm6[ilow]) >> 15;
+	rlow = g722_limit(b->s + wd, -16384, 16383);
+
+	/* INVQAL */
+	dlow = (b->det * g722_qm4[ilow >> 2]) >> 15;
+
+	/* LOGSCL, SCALEL */
+	wd    = (b->nb * 127) >> 7;
+	wd   += g722_wl[g722_rl42[ilow >> 2]];
+	b->nb  = g722_limit(wd, 0, 18432);
+	b->det = g722_scale(b->nb, 8);
+
+	g722_block4(b, dlow);
+	return rlow;
+}
+
+static inline int g722_decode_high(struct dect_g722_band *b, unsigned int ihigh)
+{
+	int rhigh, dhigh, wd;
+
+	/* INVQAH, RECONS, LIMIT */
+	dhigh = (b->det * g722_qm2[ihigh]) >> 15;
+	rhigh = g722_limit(b->s + dhigh, -16384, 16383);
+
+	/* LOGSCH, SCALEH */
+	wd    = (b->nb * 127) >> 7;
+	wd   += g722_wh[g722_rh2[ihigh]];
+	b->nb  = g722_limit(wd, 0, 22528);
+	b->det = g722_scale(b->nb, 10);
+
+	g722_block4(b, dhigh);
+	return rhigh;
+}
+
+void dect_g722_init(struct dect_g722_state *s)
+{
+	memset(s, 0, sizeof(*s));
+	s->band[0].det = 32;
+	s->band[1].det = 8;
+}
+
+/**
+ * dect_g722_decode - decode a buffer of G.722 code words
+ *
+ * @s:		decoder state
+ * @dst:	output buffer for 2 * @len samples
+ * @src:	code words
+ * @len:	number of code words in @src
+ */
+void dect_g722_decode(struct dect_g722_state *s, int16_t *dst,
+		      const uint8_t *src, unsigned int len)
+{
+	int rlow, rhigh, xout1, xout2;
+	unsigned int i, j;
+
+	for (j = 0; j < len; j++) {
+		rlow  = g722_decode_low(&s->band[0], src[j] & 0x3f);
+		rhigh = g722_decode_high(&s->band[1], src[j] >> 6);
+
+		/* Receive QMF */
+		memmove(s->x, s->x + 2, 22 * sizeof(s->x[0]));
+		s->x[22] = rlow + rhigh;
+		s->x[23] = rlow - rhigh;
+
+		xout1 = xout2 = 0;
+		for (i = 0; i < 12; i++) {
+			xout2 += s->x[2 * i] * g722_qmf_coeffs[i];
+			xout1 += s->x[2 * i + 1] * g722_qmf_coeffs[11 - i];
+		}
+		*dst++ = g722_saturate(xout1 >> 11);
+		*dst++ = g722_saturate(xout2 >> 11);
+	}
+}
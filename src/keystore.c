@@ -0,0 +1,351 @@
+/*
+ * dectmon persistent key store
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <dect/libdect.h>
+#include <dect/auth.h>
+#include <dectmon.h>
+#include <utils.h>
+#include <list.h>
+#include <keystore.h>
+
+struct dect_key {
+	struct hlist_node		hnode;
+	struct dect_ipei		ipei;
+	uint8_t				uak[DECT_AUTH_KEY_LEN];
+};
+
+struct dect_key_update {
+	struct list_head		list;
+	struct dect_ipei		ipei;
+	uint8_t				uak[DECT_AUTH_KEY_LEN];
+};
+
+static pthread_mutex_t ks_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ks_cond = PTHREAD_COND_INITIALIZER;
+static struct hlist_head ks_hash[DECT_KEYSTORE_HASH_SIZE];
+static unsigned int ks_nkeys;
+static LIST_HEAD(ks_updates);
+static bool ks_stop;
+
+static pthread_t ks_thread;
+static bool ks_running;
+
+/* Owned by the writer thread once it has been started */
+static char ks_name[PATH_MAX];
+static FILE *ks_file;
+static unsigned int ks_lines;
+static bool ks_stale;
+
+static unsigned int dect_keystore_hash(const struct dect_ipei *ipei)
+{
+	uint64_t key = (uint64_t)ipei->emc << 32 | ipei->psn;
+
+	return (key * 0x9e3779b97f4a7c15ULL) >> (64 - DECT_KEYSTORE_HASH_BITS);
+}
+
+static bool dect_ipei_equal(const struct dect_ipei *i1,
+			    const struct dect_ipei *i2)
+{
+	return i1->emc == i2->emc && i1->psn == i2->psn;
+}
+
+/* Must be called with ks_lock held */
+static struct dect_key *dect_keystore_find(const struct dect_ipei *ipei)
+{
+	struct hlist_node *n;
+	struct dect_key *key;
+
+	hlist_for_each_entry(key, n, &ks_hash[dect_keystore_hash(ipei)], hnode) {
+		if (dect_ipei_equal(&key->ipei, ipei))
+			return key;
+	}
+	return NULL;
+}
+
+/* Must be called with ks_lock held */
+static int dect_keystore_set(const struct dect_ipei *ipei, const uint8_t *uak)
+{
+	struct dect_key *key;
+
+	key = dect_keystore_find(ipei);
+	if (key == NULL) {
+		key = calloc(1, sizeof(*key));
+		if (key == NULL)
+			return -1;
+		key->ipei = *ipei;
+		hlist_add_head(&key->hnode, &ks_hash[dect_keystore_hash(ipei)]);
+		ks_nkeys++;
+	}
+	memcpy(key->uak, uak, sizeof(key->uak));
+	return 0;
+}
+
+bool dect_keystore_lookup(const struct dect_ipei *ipei, uint8_t *uak)
+{
+	struct dect_key *key;
+
+	pthread_mutex_lock(&ks_lock);
+	key = dect_keystore_find(ipei);
+	if (key != NULL)
+		memcpy(uak, key->uak, sizeof(key->uak));
+	pthread_mutex_unlock(&ks_lock);
+	return key != NULL;
+}
+
+void dect_keystore_update(const struct dect_ipei *ipei, const uint8_t *uak)
+{
+	struct dect_key_update *upd;
+	bool queued = false;
+
+	upd = malloc(sizeof(*upd));
+
+	pthread_mutex_lock(&ks_lock);
+	dect_keystore_set(ipei, uak);
+	/* Without a writer thread updates would accumulate forever */
+	if (upd != NULL && ks_running) {
+		upd->ipei = *ipei;
+		memcpy(upd->uak, uak, sizeof(upd->uak));
+		list_add_tail(&upd->list, &ks_updates);
+		pthread_cond_signal(&ks_cond);
+		queued = true;
+	}
+	pthread_mutex_unlock(&ks_lock);
+
+	if (!queued) {
+		dectmon_log("keystore: key not persisted\n");
+		free(upd);
+	}
+}
+
+static void dect_keystore_write(FILE *f, const struct dect_ipei *ipei,
+				const uint8_t *uak)
+{
+	char ipei_str[DECT_IPEI_STRING_LEN + 1];
+	unsigned int i;
+
+	dect_format_ipei_string(ipei, ipei_str);
+	fprintf(f, "%s|", ipei_str);
+	for (i = 0; i < DECT_AUTH_KEY_LEN; i++)
+		fprintf(f, "%02x", uak[i]);
+	fprintf(f, "\n");
+}
+
+static int dect_keystore_parse(const char *line, struct dect_ipei *ipei,
+			       uint8_t *uak)
+{
+	char ipei_str[DECT_IPEI_STRING_LEN + 1];
+	unsigned int i;
+	int n;
+
+	if (sscanf(line, "%13[^|]|%n", ipei_str, &n) != 1)
+		return -1;
+	line += n;
+
+	for (i = 0; i < DECT_AUTH_KEY_LEN; i++, line += 2) {
+		if (sscanf(line, "%02hhx", &uak[i]) != 1)
+			return -1;
+	}
+
+	memset(ipei, 0, sizeof(*ipei));
+	if (!dect_parse_ipei_string(ipei, ipei_str))
+		return -1;
+	return 0;
+}
+
+static int dect_keystore_load(void)
+{
+	uint8_t uak[DECT_AUTH_KEY_LEN];
+	struct dect_ipei ipei;
+	char line[128];
+	FILE *f;
+
+	f = fopen(ks_name, "r");
+	if (f == NULL)
+		return 0;
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		ks_lines++;
+		if (dect_keystore_parse(line, &ipei, uak) < 0)
+			continue;
+		if (dect_keystore_set(&ipei, uak) < 0)
+			break;
+	}
+	fclose(f);
+	return 0;
+}
+
+/*
+ * Rewrite the file with one line per key. The new file is written to a
+ * temporary file which atomically replaces the old one once complete.
+ * Updates arriving in the meantime are contained in the snapshot and are
+ * additionally appended to the new file.
+ */
+static void dect_keystore_compact(void)
+{
+	char name[PATH_MAX];
+	struct dect_key *keys, *key;
+	struct hlist_node *n;
+	unsigned int nkeys = 0, i;
+	FILE *f;
+
+	pthread_mutex_lock(&ks_lock);
+	keys = malloc(ks_nkeys * sizeof(*keys));
+	if (keys == NULL) {
+		pthread_mutex_unlock(&ks_lock);
+		return;
+	}
+	for (i = 0; i < array_size(ks_hash); i++) {
+		hlist_for_each_entry(key, n, &ks_hash[i], hnode)
+			keys[nkeys++] = *key;
+	}
+	pthread_mutex_unlock(&ks_lock);
+
+	snprintf(name, sizeof(name), "%s.tmp", ks_name);
+	f = fopen(name, "w");
+	if (f == NULL)
+		goto out;
+	for (i = 0; i < nkeys; i++)
+		dect_keystore_write(f, &keys[i].ipei, keys[i].uak);
+	if (fflush(f) || fsync(fileno(f)) < 0) {
+		fclose(f);
+		unlink(name);
+		goto out;
+	}
+	fclose(f);
+
+	if (rename(name, ks_name) < 0) {
+		unlink(name);
+		goto out;
+	}
+
+	/*
+	 * The old handle refers to the replaced file. If the new one can't be
+	 * opened, keep writing to it and retry the compaction with the next
+	 * update, so updates written in the meantime are not lost.
+	 */
+	f = fopen(ks_name, "a");
+	if (f == NULL) {
+		dectmon_log("keystore: failed to reopen %s: %s\n",
+			    ks_name, strerror(errno));
+		ks_stale = true;
+		goto out;
+	}
+	fclose(ks_file);
+	ks_file  = f;
+	ks_lines = nkeys;
+	ks_stale = false;
+out:
+	free(keys);
+}
+
+static void *dect_keystore_writer(void *arg)
+{
+	struct dect_key_update *upd, *next;
+	LIST_HEAD(updates);
+	unsigned int nkeys;
+	bool stop;
+
+	pthread_mutex_lock(&ks_lock);
+	for (;;) {
+		while (list_empty(&ks_updates) && !ks_stop)
+			pthread_cond_wait(&ks_cond, &ks_lock);
+
+		list_splice_init(&ks_updates, &updates);
+		nkeys = ks_nkeys;
+		stop  = ks_stop;
+		pthread_mutex_unlock(&ks_lock);
+
+		list_for_each_entry_safe(upd, next, &updates, list) {
+			if (ks_file != NULL) {
+				dect_keystore_write(ks_file, &upd->ipei, upd->uak);
+				ks_lines++;
+			}
+			list_del(&upd->list);
+			free(upd);
+		}
+		if (ks_file != NULL)
+			fflush(ks_file);
+
+		if (ks_lines > 2 * nkeys + DECT_KEYSTORE_COMPACT_MIN || ks_stale)
+			dect_keystore_compact();
+
+		pthread_mutex_lock(&ks_lock);
+		if (stop && list_empty(&ks_updates))
+			break;
+	}
+	pthread_mutex_unlock(&ks_lock);
+	return NULL;
+}
+
+int dect_keystore_init(void)
+{
+	const char *home = getenv("HOME");
+	int err;
+
+	snprintf(ks_name, sizeof(ks_name), "%s/%s",
+		 home ? home : ".", DECT_KEYSTORE_FILE);
+	if (dect_keystore_load() < 0)
+		return -1;
+
+	ks_file = fopen(ks_name, "a");
+	if (ks_file == NULL)
+		return -1;
+
+	err = pthread_create(&ks_thread, NULL, dect_keystore_writer, NULL);
+	if (err) {
+		fclose(ks_file);
+		ks_file = NULL;
+		errno = err;
+		return -1;
+	}
+	pthread_mutex_lock(&ks_lock);
+	ks_running = true;
+	pthread_mutex_unlock(&ks_lock);
+	return 0;
+}
+
+void dect_keystore_exit(void)
+{
+	struct hlist_node *n, *tmp;
+	struct dect_key *key;
+	unsigned int i;
+
+	if (ks_running) {
+		pthread_mutex_lock(&ks_lock);
+		ks_stop = true;
+		pthread_cond_signal(&ks_cond);
+		pthread_mutex_unlock(&ks_lock);
+
+		pthread_join(ks_thread, NULL);
+
+		pthread_mutex_lock(&ks_lock);
+		ks_running = false;
+		pthread_mutex_unlock(&ks_lock);
+	}
+
+	if (ks_file != NULL)
+		fclose(ks_file);
+
+	for (i = 0; i < array_size(ks_hash); i++) {
+		hlist_for_each_entry_safe(key, n, tmp, &ks_hash[i], hnode) {
+			hlist_del(&key->hnode);
+			free(key);
+		}
+	}
+	ks_nkeys = 0;
+}
@@ -0,0 +1,313 @@
+/*
+ * dectmon asynchronous log sink
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include <dectmon.h>
+#include <utils.h>
+#include <cli.h>
+#include <log.h>
+
+/*
+ * Bounded MPSC queue: each entry carries a sequence number which equals
+ * its position when free and position + 1 once a message has been
+ * published. Producers claim a position by advancing the tail with a
+ * CAS, the single consumer releases entries by advancing the sequence
+ * number by the queue size.
+ */
+struct dectmon_log_entry {
+	unsigned long			seq;
+	unsigned int			len;
+	char				msg[DECTMON_LOG_MSG_SIZE];
+};
+
+#define LOG_BATCH_SIZE		16384
+
+static struct dectmon_log_entry log_queue[DECTMON_LOG_ENTRIES];
+static unsigned long log_tail;
+static unsigned long log_head;
+static unsigned long log_dropped;
+static unsigned long log_truncated;
+
+static pthread_t log_thread;
+static bool log_ready;
+static bool log_running;
+static bool log_stop;
+static int log_sleeping;
+static int log_efd = -1;
+
+static FILE *logfile;
+static const char *logname;
+static unsigned long logsize;
+static unsigned long log_rotate_size;
+
+static struct dectmon_log_entry *dectmon_log_reserve(unsigned long *ppos)
+{
+	struct dectmon_log_entry *e;
+	unsigned long pos, seq;
+
+	pos = __atomic_load_n(&log_tail, __ATOMIC_RELAXED);
+	for (;;) {
+		e = &log_queue[pos % DECTMON_LOG_ENTRIES];
+		seq = __atomic_load_n(&e->seq, __ATOMIC_ACQUIRE);
+		if (seq == pos) {
+			if (__atomic_compare_exchange_n(&log_tail, &pos, pos + 1,
+							true, __ATOMIC_RELAXED,
+							__ATOMIC_RELAXED))
+				break;
+		} else if ((long)(seq - pos) < 0) {
+			__atomic_fetch_add(&log_dropped, 1, __ATOMIC_RELAXED);
+			return NULL;
+		} else
+			pos = __atomic_load_n(&log_tail, __ATOMIC_RELAXED);
+	}
+
+	*ppos = pos;
+	return e;
+}
+
+static void dectmon_log_commit(struct dectmon_log_entry *e, unsigned long pos,
+			       int len)
+{
+	uint64_t val = 1;
+
+	if (len < 0)
+		len = 0;
+	else if (len >= (int)sizeof(e->msg)) {
+		__atomic_fetch_add(&log_truncated, 1, __ATOMIC_RELAXED);
+		len = sizeof(e->msg) - 1;
+	}
+	e->len = len;
+	__atomic_store_n(&e->seq, pos + 1, __ATOMIC_RELEASE);
+
+	/* Only wake up the sink if it is waiting for new messages */
+	if (__atomic_exchange_n(&log_sleeping, 0, __ATOMIC_ACQ_REL))
+		if (write(log_efd, &val, sizeof(val)) < 0)
+			return;
+}
+
+void dectmon_log(const char *fmt, ...)
+{
+	struct dectmon_log_entry *e;
+	unsigned long pos;
+	va_list ap;
+	int len;
+
+	/* The queue is not set up yet, log directly */
+	if (!__atomic_load_n(&log_ready, __ATOMIC_ACQUIRE)) {
+		va_start(ap, fmt);
+		vfprintf(stderr, fmt, ap);
+		va_end(ap);
+		return;
+	}
+
+	e = dectmon_log_reserve(&pos);
+	if (e == NULL)
+		return;
+
+	va_start(ap, fmt);
+	len = vsnprintf(e->msg, sizeof(e->msg), fmt, ap);
+	va_end(ap);
+
+	dectmon_log_commit(e, pos, len);
+}
+
+/* Log preformatted output without going through printf */
+void dectmon_log_buf(const char *buf, unsigned int len)
+{
+	struct dectmon_log_entry *e;
+	unsigned long pos;
+
+	if (!__atomic_load_n(&log_ready, __ATOMIC_ACQUIRE)) {
+		fwrite(buf, len, 1, stderr);
+		return;
+	}
+
+	e = dectmon_log_reserve(&pos);
+	if (e == NULL)
+		return;
+
+	memcpy(e->msg, buf, min(len, (unsigned int)sizeof(e->msg)));
+	dectmon_log_commit(e, pos, len);
+}
+
+static void dectmon_log_rotate(void)
+{
+	char old[PATH_MAX], new[PATH_MAX];
+	unsigned int i;
+
+	fclose(logfile);
+	for (i = DECTMON_LOG_ROTATE - 1; i > 0; i--) {
+		snprintf(old, sizeof(old), "%s.%u", logname, i - 1);
+		snprintf(new, sizeof(new), "%s.%u", logname, i);
+		if (i == 1)
+			snprintf(old, sizeof(old), "%s", logname);
+		rename(old, new);
+	}
+
+	logfile = fopen(logname, "w");
+	logsize = 0;
+}
+
+static void dectmon_log_write(const char *buf, unsigned int len)
+{
+	cli_write(buf, len);
+
+	if (logfile == NULL)
+		return;
+
+	fwrite(buf, len, 1, logfile);
+	fflush(logfile);
+	logsize += len;
+	if (log_rotate_size && logsize >= log_rotate_size)
+		dectmon_log_rotate();
+}
+
+/*
+ * Move all published messages into a batch buffer, returns the number of
+ * bytes collected.
+ */
+static unsigned int dectmon_log_collect(char *buf, unsigned int size)
+{
+	struct dectmon_log_entry *e;
+	unsigned int len = 0;
+
+	for (;;) {
+		e = &log_queue[log_head % DECTMON_LOG_ENTRIES];
+		if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) != log_head + 1)
+			break;
+		if (len + e->len > size)
+			break;
+
+		memcpy(buf + len, e->msg, e->len);
+		len += e->len;
+
+		__atomic_store_n(&e->seq, log_head + DECTMON_LOG_ENTRIES,
+				 __ATOMIC_RELEASE);
+		log_head++;
+	}
+	return len;
+}
+
+static void dectmon_log_report_drops(void)
+{
+	static unsigned long dropped, truncated;
+	unsigned long d, t;
+	char buf[128];
+	int len;
+
+	d = __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+	t = __atomic_load_n(&log_truncated, __ATOMIC_RELAXED);
+	if (d == dropped && t == truncated)
+		return;
+
+	len = snprintf(buf, sizeof(buf),
+		       "log: %lu messages dropped, %lu truncated\n",
+		       d - dropped, t - truncated);
+	dectmon_log_write(buf, len);
+	dropped   = d;
+	truncated = t;
+}
+
+static void *dectmon_log_sink(void *arg)
+{
+	static char buf[LOG_BATCH_SIZE];
+	unsigned int len;
+	uint64_t val;
+
+	for (;;) {
+		while ((len = dectmon_log_collect(buf, sizeof(buf))) > 0)
+			dectmon_log_write(buf, len);
+		dectmon_log_report_drops();
+
+		if (__atomic_load_n(&log_stop, __ATOMIC_ACQUIRE))
+			break;
+
+		/* Announce that we're going to sleep, then recheck the queue
+		 * to avoid missing a wakeup from a producer that published
+		 * its message before seeing the flag.
+		 */
+		__atomic_store_n(&log_sleeping, 1, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&log_queue[log_head % DECTMON_LOG_ENTRIES].seq,
+				    __ATOMIC_SEQ_CST) == log_head + 1 ||
+		    __atomic_load_n(&log_stop, __ATOMIC_SEQ_CST)) {
+			__atomic_store_n(&log_sleeping, 0, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		if (read(log_efd, &val, sizeof(val)) < 0 && errno != EINTR)
+			break;
+	}
+	return NULL;
+}
+
+int dectmon_log_open(const char *name, unsigned long rotate_size)
+{
+	logfile = fopen(name, "a");
+	if (logfile == NULL)
+		return -1;
+
+	fseek(logfile, 0, SEEK_END);
+	logsize         = ftell(logfile);
+	logname         = name;
+	log_rotate_size = rotate_size;
+	return 0;
+}
+
+int dectmon_log_init(void)
+{
+	unsigned int i;
+
+	log_efd = eventfd(0, 0);
+	if (log_efd < 0)
+		return -1;
+
+	/*
+	 * Messages logged before this point went to stderr, so the sequence
+	 * numbers can be initialized without racing against producers.
+	 */
+	for (i = 0; i < array_size(log_queue); i++)
+		log_queue[i].seq = i;
+	__atomic_store_n(&log_ready, true, __ATOMIC_RELEASE);
+
+	if (pthread_create(&log_thread, NULL, dectmon_log_sink, NULL)) {
+		__atomic_store_n(&log_ready, false, __ATOMIC_RELEASE);
+		close(log_efd);
+		return -1;
+	}
+	log_running = true;
+	return 0;
+}
+
+void dectmon_log_exit(void)
+{
+	uint64_t val = 1;
+
+	if (!log_running)
+		return;
+
+	__atomic_store_n(&log_stop, true, __ATOMIC_SEQ_CST);
+	if (write(log_efd, &val, sizeof(val)) < 0)
+		return;
+	pthread_join(log_thread, NULL);
+	log_running = false;
+
+	close(log_efd);
+	if (logfile != NULL)
+		fclose(logfile);
+}
@@ -17,6 +17,9 @@
 #include <phl.h>
 #include <mac.h>
 #include <dsc.h>
+#include <trace.h>
+#include <evlog.h>
+#include <cdr.h>
 
 #define BITS_PER_BYTE	8
 
@@ -538,9 +541,11 @@ static void dect_tbc_release(struct dect_handle *dh, struct dect_tbc *tbc)
 	struct dect_handle_priv *priv = dect_handle_priv(dh);
 
 	tbc_log(tbc, "release\n");
+	dect_evlog(bearer, priv->index, DECT_EV_BEARER_RELEASE, tbc);
 
 	dect_mac_dis_ind(dh, &tbc->mbc[DECT_MODE_FP].mc);
 	dect_mac_dis_ind(dh, &tbc->mbc[DECT_MODE_PP].mc);
+	dect_dl_release(dh, &tbc->dl);
 
 	if (dect_timer_running(tbc->timer))
 		dect_timer_stop(dh, tbc->timer);
@@ -551,11 +556,25 @@ static void dect_tbc_release(struct dect_handle *dh, struct dect_tbc *tbc)
 	free(tbc);
 }
 
+/* Release all bearers, both slots of a bearer refer to the same TBC */
+void dect_tbc_flush(struct dect_handle *dh)
+{
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	unsigned int i;
+
+	for (i = 0; i < array_size(priv->slots); i++) {
+		if (priv->slots[i] != NULL)
+			dect_tbc_release(dh, priv->slots[i]);
+	}
+}
+
 static void dect_tbc_timeout(struct dect_handle *dh, struct dect_timer *timer)
 {
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
 	struct dect_tbc *tbc = dect_timer_data(timer);
 
 	tbc_log(tbc, "timeout\n");
+	dect_evlog(bearer, priv->index, DECT_EV_BEARER_TIMEOUT, tbc);
 	dect_tbc_release(dh, tbc);
 }
 
@@ -595,6 +614,8 @@ static struct dect_tbc *dect_tbc_init(struct dect_handle *dh,
 	priv->slots[slot]  = tbc;
 	priv->slots[slot2] = tbc;
 	tbc_log(tbc, "establish: slot %u/%u\n", slot, slot2);
+	dect_evlog(bearer, priv->index, DECT_EV_BEARER_ESTABLISH, tbc);
+	dect_dl_establish(dh, &tbc->dl);
 
 	return tbc;
 
@@ -630,6 +651,7 @@ static void dect_dsc_cipher(struct dect_tbc *tbc, struct dect_msg_buf *mb)
 static void dect_tbc_rcv(struct dect_handle *dh, struct dect_tbc *tbc,
 			 struct dect_msg_buf *mb, struct dect_tail_msg *tm)
 {
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
 	enum dect_b_identifications b_id;
 	struct dect_mbc *mbc;
 	unsigned int i;
@@ -710,6 +732,9 @@ static void dect_tbc_rcv(struct dect_handle *dh, struct dect_tbc *tbc,
 		case DECT_ENCCTRL_START_GRANT:
 			tbc_log(tbc, "ciphering enabled: %s\n",
 			        slot < 12 ? "FP->PP" : "PP->FP");
+			dect_evlog(bearer, priv->index, DECT_EV_BEARER_CIPHER, tbc);
+			if (tbc->dl.pt != NULL)
+				dect_cdr_cipher(tbc->dl.pt);
 			break;
 		default:
 			break;
@@ -728,12 +753,15 @@ void dect_mac_rcv(struct dect_handle *dh, struct dect_msg_buf *mb)
 	enum dect_b_identifications b_id;
 	struct dect_tail_msg tm;
 
+	dect_evlog(mac, priv->index, mb);
+
 	a_id = (mb->data[0] & DECT_HDR_TA_MASK) >> DECT_HDR_TA_SHIFT;
 	b_id = (mb->data[0] & DECT_HDR_BA_MASK) >> DECT_HDR_BA_SHIFT;
 	mac_print("slot: %02u A: %x B: %x ", mb->slot, a_id, b_id);
 
 	dect_parse_tail_msg(&tm, mb);
 	//dect_hexdump("MAC RCV", mb->data, mb->len);
+	dect_trace_stage(DECT_TRACE_MAC);
 
 	if (tbc != NULL)
 		return dect_tbc_rcv(dh, tbc, mb, &tm);
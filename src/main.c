@@ -10,6 +10,12 @@
 #include <stdio.h>
 #include <errno.h>
 #include <getopt.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <linux/dect.h>
 
 #include <dect/libdect.h>
 #include <dect/raw.h>
@@ -18,120 +24,169 @@
 #include <raw.h>
 #include <cli.h>
 #include <ops.h>
+#include <trace.h>
+#include <evlog.h>
+#include <log.h>
+#include <scan.h>
+#include <keystore.h>
+#include <cdr.h>
+#include <record.h>
+#include <rtp.h>
+
+#define DECT_HANDLE_HASH_BITS	6
+#define DECT_HANDLE_HASH_SIZE	(1 << DECT_HANDLE_HASH_BITS)
 
-#define DECT_MAX_CLUSTERS	16
-#define DECT_LOCK_TIMEOUT	15
-
-#define cluster_log(priv, fmt, args...) \
-	dectmon_log("%s: " fmt, \
-		    ((struct dect_handle_priv *)dect_handle_priv(dh))->cluster, \
-		    ## args)
-
+/*
+ * Locking: the handle list is protected by dect_handles_mutex, each
+ * cluster's state by the lock of its event loop. Lock order is list, loop,
+ * scan coordinator.
+ */
 LIST_HEAD(dect_handles);
-static unsigned int locked;
-static bool scan;
+static pthread_mutex_t dect_handles_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct hlist_head dect_handles_name_hash[DECT_HANDLE_HASH_SIZE];
 
-static FILE *logfile;
 static FILE *dumpfile;
 
-void dectmon_log(const char *fmt, ...)
+/* Lock the handle list and all clusters for CLI access */
+void dect_handles_lock(void)
 {
-	va_list ap;
-
-	va_start(ap, fmt);
-	cli_display(fmt, ap);
-	va_end(ap);
+	struct dect_handle_priv *priv;
 
-	if (logfile) {
-		va_start(ap, fmt);
-		vfprintf(logfile, fmt, ap);
-		va_end(ap);
-	}
+	pthread_mutex_lock(&dect_handles_mutex);
+	list_for_each_entry(priv, &dect_handles, list)
+		dect_loop_lock(priv->loop);
 }
 
-static struct dect_handle_priv *dect_handle_lookup(const struct dect_ari *pari)
+void dect_handles_unlock(void)
 {
 	struct dect_handle_priv *priv;
 
 	list_for_each_entry(priv, &dect_handles, list)
-		if (!dect_ari_cmp(pari, &priv->pari))
-			return priv;
-	return NULL;
+		dect_loop_unlock(priv->loop);
+	pthread_mutex_unlock(&dect_handles_mutex);
 }
 
-struct dect_handle_priv *dect_handle_get_by_name(const char *name)
+static unsigned int dect_name_hash(const char *name)
 {
-	struct dect_handle_priv *priv;
+	unsigned int hash = 2166136261U;
 
-	list_for_each_entry(priv, &dect_handles, list)
-		if (!strcmp(name, priv->cluster))
-			return priv;
-	return NULL;
+	if (name == NULL)
+		return 0;
+	while (*name != '\0')
+		hash = (hash ^ (uint8_t)*name++) * 16777619U;
+	return hash & (DECT_HANDLE_HASH_SIZE - 1);
 }
 
-static void dect_lock_timer(struct dect_handle *dh, struct dect_timer *timer)
+static bool dect_name_cmp(const char *n1, const char *n2)
 {
-	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	if (n1 == NULL || n2 == NULL)
+		return n1 == n2;
+	return !strcmp(n1, n2);
+}
 
-	cluster_log(dh, "timeout, lock failed\n");
-	memset(&priv->pari, 0, sizeof(priv->pari));
-	dect_llme_scan_req(dh);
+static void dect_handles_add(struct dect_handle_priv *priv)
+{
+	pthread_mutex_lock(&dect_handles_mutex);
+	list_add_tail(&priv->list, &dect_handles);
+	hlist_add_head(&priv->name_node,
+		       &dect_handles_name_hash[dect_name_hash(priv->cluster)]);
+	pthread_mutex_unlock(&dect_handles_mutex);
 }
 
-static void dect_mac_me_info_ind(struct dect_handle *dh,
-				 const struct dect_ari *pari,
-				 const struct dect_fp_capabilities *fpc)
+static void dect_handles_del(struct dect_handle_priv *priv)
 {
-	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	pthread_mutex_lock(&dect_handles_mutex);
+	list_del(&priv->list);
+	hlist_del(&priv->name_node);
+	pthread_mutex_unlock(&dect_handles_mutex);
+}
 
-	if (!scan)
-		return;
+/* Must be called with the handle list locked */
+struct dect_handle_priv *dect_handle_get_by_name(const char *name)
+{
+	struct dect_handle_priv *priv;
+	struct hlist_node *n;
 
-	if (pari != NULL) {
-		if (dect_handle_lookup(pari) == NULL) {
-			dect_llme_mac_me_info_res(dh, pari);
-			priv->pari = *pari;
-			dect_timer_start(dh, priv->lock_timer, DECT_LOCK_TIMEOUT);
-		}
-	} else if (fpc->fpc != 0) {
-		if (dect_timer_running(priv->lock_timer)) {
-			locked++;
-			cluster_log(dh, "locked (%u): EMC: %.4x FPN: %.5x\n",
-				    locked, priv->pari.emc, priv->pari.fpn);
-
-			dect_timer_stop(dh, priv->lock_timer);
-			priv->locked = true;
-		}
-	} else {
-		locked--;
-		cluster_log(dh, "unlocked (%u): EMC: %.4x FPN: %.5x\n",
-			    locked, priv->pari.emc, priv->pari.fpn);
-
-		memset(&priv->pari, 0, sizeof(priv->pari));
-		priv->locked = false;
-		dect_llme_scan_req(dh);
-	}
+	hlist_for_each_entry(priv, n, &dect_handles_name_hash[dect_name_hash(name)],
+			     name_node)
+		if (dect_name_cmp(name, priv->cluster))
+			return priv;
+	return NULL;
 }
 
-static struct dect_llme_ops_ llme_ops = {
-	.mac_me_info_ind	= dect_mac_me_info_ind,
-};
-
 static void dect_raw_rcv(struct dect_handle *dh, struct dect_fd *dfd,
 			 struct dect_msg_buf *mb)
 {
 	struct dect_raw_frame_hdr f;
 
+	dect_trace_frame_start();
 	if (dumpfile != NULL) {
 		f.slot	 = mb->slot;
 		f.frame	 = mb->frame;
 		f.mfn 	 = mb->mfn;
 		f.len	 = mb->len;
 
-		fwrite(&f, sizeof(f), 1, dumpfile);
-		fwrite(mb->data, mb->len, 1, dumpfile);
+		flockfile(dumpfile);
+		fwrite_unlocked(&f, sizeof(f), 1, dumpfile);
+		fwrite_unlocked(mb->data, mb->len, 1, dumpfile);
+		funlockfile(dumpfile);
 	}
 	dect_mac_rcv(dh, mb);
+	dect_trace_stage(DECT_TRACE_FRAME);
+}
+
+/*
+ * Receive all pending frames of a raw socket with as few system calls as
+ * possible. One batch covers a full TDMA frame.
+ */
+#define DECT_RAW_BATCH		DECT_FRAME_SIZE
+
+static void dect_raw_rcv_batch(struct dect_handle *dh, struct dect_fd *dfd)
+{
+	struct dect_msg_buf mbs[DECT_RAW_BATCH], *mb;
+	struct mmsghdr msgs[DECT_RAW_BATCH];
+	struct iovec iov[DECT_RAW_BATCH];
+	char cbuf[DECT_RAW_BATCH][CMSG_SPACE(sizeof(struct dect_raw_auxdata))];
+	const struct dect_raw_auxdata *aux;
+	struct cmsghdr *cmsg;
+	int i, n;
+
+	do {
+		for (i = 0; i < DECT_RAW_BATCH; i++) {
+			mb = &mbs[i];
+			memset(mb, 0, offsetof(struct dect_msg_buf, head));
+			mb->data = mb->head;
+
+			iov[i].iov_base = mb->data;
+			iov[i].iov_len  = sizeof(mb->head);
+
+			memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+			msgs[i].msg_hdr.msg_iov        = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen     = 1;
+			msgs[i].msg_hdr.msg_control    = cbuf[i];
+			msgs[i].msg_hdr.msg_controllen = sizeof(cbuf[i]);
+		}
+
+		n = recvmmsg(dect_fd_num(dfd), msgs, DECT_RAW_BATCH,
+			     MSG_DONTWAIT, NULL);
+
+		for (i = 0; i < n; i++) {
+			mb = &mbs[i];
+			mb->len = msgs[i].msg_len;
+
+			for (cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL;
+			     cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+				if (cmsg->cmsg_level != SOL_DECT ||
+				    cmsg->cmsg_type != DECT_RAW_AUXDATA)
+					continue;
+				aux = (void *)CMSG_DATA(cmsg);
+				mb->mfn   = aux->mfn;
+				mb->frame = aux->frame;
+				mb->slot  = aux->slot;
+			}
+			dect_raw_rcv(dh, dfd, mb);
+		}
+	} while (n == DECT_RAW_BATCH);
 }
 
 static struct dect_raw_ops raw_ops = {
@@ -140,7 +195,7 @@ static struct dect_raw_ops raw_ops = {
 
 static struct dect_ops ops = {
 	.priv_size		= sizeof(struct dect_handle_priv),
-	.llme_ops		= &llme_ops,
+	.llme_ops		= &dect_scan_llme_ops,
 	.raw_ops		= &raw_ops,
 };
 
@@ -157,7 +212,7 @@ static void dect_debug(enum dect_debug_subsys subsys, const char *fmt,
 	}
 }
 
-#define OPTSTRING "c:sm:d:n:a:p:l:w:h"
+#define OPTSTRING "c:sm:d:n:x:a:R:f:V:S:p:l:r:w:b:D:t:HC:P:h"
 
 enum {
 	OPT_CLUSTER	= 'c',
@@ -165,10 +220,22 @@ enum {
 	OPT_DUMP_MAC	= 'm',
 	OPT_DUMP_DLC	= 'd',
 	OPT_DUMP_NWK	= 'n',
+	OPT_HEXDUMP	= 'x',
 	OPT_AUDIO	= 'a',
+	OPT_RECORD	= 'R',
+	OPT_RECORD_FMT	= 'f',
+	OPT_SILENCE	= 'V',
+	OPT_STREAM	= 'S',
 	OPT_AUTH_PIN	= 'p',
 	OPT_LOGFILE	= 'l',
+	OPT_LOG_ROTATE	= 'r',
 	OPT_DUMPFILE	= 'w',
+	OPT_EVLOG	= 'b',
+	OPT_CDR		= 'D',
+	OPT_TRACE	= 't',
+	OPT_HEADLESS	= 'H',
+	OPT_CONTROL	= 'C',
+	OPT_PIN_CPU	= 'P',
 	OPT_HELP	= 'h',
 };
 
@@ -178,10 +245,22 @@ static const struct option dectmon_opts[] = {
 	{ .name = "dump-mac", .has_arg = true,  .flag = 0, .val = OPT_DUMP_MAC, },
 	{ .name = "dump-dlc", .has_arg = true,  .flag = 0, .val = OPT_DUMP_DLC, },
 	{ .name = "dump-nwk", .has_arg = true,  .flag = 0, .val = OPT_DUMP_NWK, },
+	{ .name = "hexdump",  .has_arg = true,  .flag = 0, .val = OPT_HEXDUMP, },
 	{ .name = "audio",    .has_arg = true,  .flag = 0, .val = OPT_AUDIO, },
+	{ .name = "record",   .has_arg = true,  .flag = 0, .val = OPT_RECORD, },
+	{ .name = "record-format", .has_arg = true, .flag = 0, .val = OPT_RECORD_FMT, },
+	{ .name = "record-silence", .has_arg = true, .flag = 0, .val = OPT_SILENCE, },
+	{ .name = "stream",   .has_arg = true,  .flag = 0, .val = OPT_STREAM, },
 	{ .name = "auth-pin", .has_arg = true,  .flag = 0, .val = OPT_AUTH_PIN, },
 	{ .name = "logfile",  .has_arg = true,  .flag = 0, .val = OPT_LOGFILE, },
+	{ .name = "log-rotate", .has_arg = true, .flag = 0, .val = OPT_LOG_ROTATE, },
 	{ .name = "dumpfile", .has_arg = true,	.flag = 0, .val = OPT_DUMPFILE, },
+	{ .name = "evlog",    .has_arg = true,  .flag = 0, .val = OPT_EVLOG, },
+	{ .name = "cdr",      .has_arg = true,  .flag = 0, .val = OPT_CDR, },
+	{ .name = "trace",    .has_arg = true,  .flag = 0, .val = OPT_TRACE, },
+	{ .name = "headless", .has_arg = false, .flag = 0, .val = OPT_HEADLESS, },
+	{ .name = "control",  .has_arg = true,  .flag = 0, .val = OPT_CONTROL, },
+	{ .name = "pin-cpu",  .has_arg = true,  .flag = 0, .val = OPT_PIN_CPU, },
 	{ .name = "help",     .has_arg = false, .flag = 0, .val = OPT_HELP, },
 	{ },
 };
@@ -202,10 +281,25 @@ static void dectmon_help(const char *progname)
 	       "  -m/--dump-mac=yes/no		Dump MAC layer messages (default: no)\n"
 	       "  -d/--dump-dlc=yes/no		Dump DLC layer messages (default: no)\n"
 	       "  -n/--dump-nwk=yes/no		Dump NWK layer messages (default: yes)\n"
+	       "  -x/--hexdump=yes/no		Hexdump raw NWK messages, use with -b to log\n"
+	       "				raw messages in binary form only (default: yes)\n"
 	       "  -a/--audio=yes/no		Enable audio playback (default: no)\n"
+	       "  -R/--record=DIR		Record call audio to WAV files in DIR\n"
+	       "  -f/--record-format=FORMAT	Recording sample format: pcm, alaw or ulaw\n"
+	       "				(default: pcm)\n"
+	       "  -V/--record-silence=yes/no	Record silent frames (default: yes)\n"
+	       "  -S/--stream=DEST		Stream call audio as RTP to udp:HOST:PORT or\n"
+	       "				unix:PATH\n"
 	       "  -p/--auth-pin=PIN		Authentication PIN for Key Allocation\n"
 	       "  -l/--logfile=NAME		Log output to file\n"
+	       "  -r/--log-rotate=SIZE		Rotate logfile after SIZE kB (default: never)\n"
 	       "  -d/--dumpfile=NAME		Dump raw frames to file\n"
+	       "  -b/--evlog=NAME		Log binary events to file\n"
+	       "  -D/--cdr=NAME			Write call detail records to CSV file\n"
+	       "  -t/--trace=yes/no		Trace receive path latencies (default: no)\n"
+	       "  -H/--headless			Run without interactive terminal\n"
+	       "  -C/--control=PATH		Accept commands on unix socket PATH (implies -H)\n"
+	       "  -P/--pin-cpu=CPU		Pin cluster threads to CPUs starting at CPU\n"
 	       "  -h/--help			Show this help text\n"
 	       "\n",
 	       progname);
@@ -224,49 +318,307 @@ static uint32_t opt_yesno(const char *arg, uint32_t opts, uint32_t flag)
 }
 
 const char *auth_pin = "0000";
-uint32_t dumpopts = DECTMON_DUMP_NWK;
+uint32_t dumpopts = DECTMON_DUMP_NWK | DECTMON_DUMP_HEX;
+
+/*
+ * Cluster indices identify clusters in the event log, which stores them in
+ * eight bits. Indices of closed handles are reused, the event log records
+ * the new name when a handle is opened.
+ */
+#define DECTMON_INDEX_MAX	256
+
+static pthread_mutex_t dectmon_index_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t dectmon_index_map[DECTMON_INDEX_MAX / 32];
+
+static int dectmon_index_alloc(void)
+{
+	unsigned int i;
+	int index = -1;
+
+	pthread_mutex_lock(&dectmon_index_lock);
+	for (i = 0; i < DECTMON_INDEX_MAX; i++) {
+		if (dectmon_index_map[i / 32] & (1U << (i % 32)))
+			continue;
+		dectmon_index_map[i / 32] |= 1U << (i % 32);
+		index = i;
+		break;
+	}
+	pthread_mutex_unlock(&dectmon_index_lock);
+	return index;
+}
+
+static void dectmon_index_free(unsigned int index)
+{
+	pthread_mutex_lock(&dectmon_index_lock);
+	dectmon_index_map[index / 32] &= ~(1U << (index % 32));
+	pthread_mutex_unlock(&dectmon_index_lock);
+}
 
 static struct dect_handle *dectmon_open_handle(struct dect_ops *ops,
+					       struct dect_loop *loop,
 					       const char *cluster)
 {
 	struct dect_handle_priv *priv;
 	struct dect_handle *dh;
+	int index;
 
+	index = dectmon_index_alloc();
+	if (index < 0) {
+		errno = ENOSPC;
+		return NULL;
+	}
+
+	dect_loop_set_current(loop);
 	dh = dect_open_handle(ops, cluster);
 	if (dh == NULL)
-		pexit("dect_open_handle");
+		goto err1;
 
 	priv = dect_handle_priv(dh);
 	priv->cluster = cluster;
+	priv->index   = index;
 	priv->dh      = dh;
+	priv->loop    = loop;
+	dect_evlog(cluster, priv->index, cluster);
 
-	priv->lock_timer = dect_timer_alloc(dh);
-	if (priv->lock_timer == NULL)
-		pexit("dect_alloc_timer");
-	dect_timer_setup(priv->lock_timer, dect_lock_timer, priv);
+	if (dect_scan_open(priv) < 0)
+		goto err2;
 
 	init_list_head(&priv->pt_list);
-	list_add_tail(&priv->list, &dect_handles);
-
+	init_list_head(&priv->pt_release_list);
 	return dh;
+
+err2:
+	dect_close_handle(dh);
+err1:
+	dectmon_index_free(index);
+	return NULL;
 }
 
 static void dectmon_close_handle(struct dect_handle_priv *priv)
 {
-	struct dect_handle *dh = priv->dh;
+	unsigned int index = priv->index;
 
-	if (dect_timer_running(priv->lock_timer))
-		dect_timer_stop(dh, priv->lock_timer);
-	dect_timer_free(dh, priv->lock_timer);
-	dect_close_handle(dh);
+	dect_tbc_flush(priv->dh);
+	dect_pt_flush(priv->dh);
+	dect_scan_close(priv);
+	dect_close_handle(priv->dh);
+	dectmon_index_free(index);
 }
 
-int main(int argc, char **argv)
+/*
+ * Cluster registry: clusters are attached and detached from the main
+ * thread only, either during startup or by CLI commands. Since CLI
+ * commands run with all clusters locked, changes are queued and carried
+ * out by dectmon_cluster_commit() once the locks have been released.
+ */
+struct dectmon_cluster {
+	struct list_head			list;
+	char					*name;
+	struct dect_loop			*loop;
+	pthread_t				thread;
+	int					cpu;
+	bool					failed;
+};
+
+enum dectmon_cluster_ops {
+	DECTMON_CLUSTER_ATTACH,
+	DECTMON_CLUSTER_DETACH,
+};
+
+struct dectmon_cluster_req {
+	struct list_head			list;
+	enum dectmon_cluster_ops		op;
+	char					*name;
+};
+
+static LIST_HEAD(dectmon_clusters);
+static LIST_HEAD(dectmon_cluster_reqs);
+static unsigned int dectmon_ncluster;
+static int dectmon_cpu = -1;
+
+/*
+ * Cluster thread: the handle is opened, run and closed in the thread
+ * owning its event loop. It becomes visible to other threads only after
+ * it is fully set up.
+ */
+static void *dectmon_cluster_thread(void *arg)
 {
-	const char *cluster[DECT_MAX_CLUSTERS] = {};
-	unsigned int ncluster = 0, i;
-	struct dect_handle_priv *priv, *next;
+	struct dectmon_cluster *cl = arg;
+	const char *name = cl->name ? cl->name : "default";
+	struct dect_handle_priv *priv;
 	struct dect_handle *dh;
+	cpu_set_t cpus;
+
+	if (cl->cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(cl->cpu, &cpus);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus))
+			dectmon_log("%s: failed to pin to CPU %d\n",
+				    name, cl->cpu);
+	}
+
+	dh = dectmon_open_handle(&ops, cl->loop, cl->name);
+	if (dh == NULL) {
+		dectmon_log("%s: failed to open handle: %s\n",
+			    name, strerror(errno));
+		goto err;
+	}
+	priv = dect_handle_priv(dh);
+
+	priv->rawsk = dect_raw_open(dh);
+	if (priv->rawsk == NULL) {
+		dectmon_log("%s: failed to open raw socket: %s\n",
+			    name, strerror(errno));
+		dectmon_close_handle(priv);
+		goto err;
+	}
+	dect_event_fd_batch(priv->rawsk, dect_raw_rcv_batch);
+
+	dect_handles_add(priv);
+	dect_loop_lock(cl->loop);
+	dect_scan_start(priv);
+	dect_loop_unlock(cl->loop);
+
+	dect_loop_run(cl->loop);
+
+	dect_scan_stop(priv);
+	dect_handles_del(priv);
+
+	dect_raw_close(dh, priv->rawsk);
+	dectmon_close_handle(priv);
+	return NULL;
+
+err:
+	/* Allow the cluster to be attached again */
+	__atomic_store_n(&cl->failed, true, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+static struct dectmon_cluster *dectmon_cluster_lookup(const char *name)
+{
+	struct dectmon_cluster *cl;
+
+	list_for_each_entry(cl, &dectmon_clusters, list)
+		if (dect_name_cmp(name, cl->name))
+			return cl;
+	return NULL;
+}
+
+static void dectmon_cluster_stop(struct dectmon_cluster *cl)
+{
+	dect_loop_stop(cl->loop);
+	pthread_join(cl->thread, NULL);
+	dect_loop_free(cl->loop);
+
+	list_del(&cl->list);
+	free(cl->name);
+	free(cl);
+}
+
+static void dectmon_cluster_start(const char *name)
+{
+	struct dectmon_cluster *cl;
+
+	cl = dectmon_cluster_lookup(name);
+	if (cl != NULL) {
+		if (!__atomic_load_n(&cl->failed, __ATOMIC_ACQUIRE)) {
+			dectmon_log("cluster '%s' is already attached\n", name);
+			return;
+		}
+		dectmon_cluster_stop(cl);
+	}
+
+	cl = calloc(1, sizeof(*cl));
+	if (cl == NULL)
+		goto err1;
+	if (name != NULL) {
+		cl->name = strdup(name);
+		if (cl->name == NULL)
+			goto err2;
+	}
+
+	cl->cpu = -1;
+	if (dectmon_cpu >= 0)
+		cl->cpu = (dectmon_cpu + dectmon_ncluster) %
+			  sysconf(_SC_NPROCESSORS_ONLN);
+
+	cl->loop = dect_loop_alloc();
+	if (cl->loop == NULL)
+		goto err3;
+	if (pthread_create(&cl->thread, NULL, dectmon_cluster_thread, cl))
+		goto err4;
+
+	list_add_tail(&cl->list, &dectmon_clusters);
+	dectmon_ncluster++;
+	return;
+
+err4:
+	dect_loop_free(cl->loop);
+err3:
+	free(cl->name);
+err2:
+	free(cl);
+err1:
+	dectmon_log("cluster '%s': %s\n", name ? name : "default",
+		    strerror(errno));
+}
+
+static void dectmon_cluster_queue(enum dectmon_cluster_ops op, const char *name)
+{
+	struct dectmon_cluster_req *req;
+
+	req = calloc(1, sizeof(*req));
+	if (req == NULL)
+		return;
+	req->op = op;
+	if (name != NULL)
+		req->name = strdup(name);
+	list_add_tail(&req->list, &dectmon_cluster_reqs);
+}
+
+void dectmon_cluster_attach(const char *name)
+{
+	dectmon_cluster_queue(DECTMON_CLUSTER_ATTACH, name);
+}
+
+void dectmon_cluster_detach(const char *name)
+{
+	dectmon_cluster_queue(DECTMON_CLUSTER_DETACH, name);
+}
+
+/* Carry out queued attach and detach requests, called without locks held */
+void dectmon_cluster_commit(void)
+{
+	struct dectmon_cluster_req *req, *next;
+	struct dectmon_cluster *cl;
+
+	list_for_each_entry_safe(req, next, &dectmon_cluster_reqs, list) {
+		switch (req->op) {
+		case DECTMON_CLUSTER_ATTACH:
+			dectmon_cluster_start(req->name);
+			break;
+		case DECTMON_CLUSTER_DETACH:
+			cl = dectmon_cluster_lookup(req->name);
+			if (cl == NULL)
+				dectmon_log("cluster '%s' is not attached\n",
+					    req->name);
+			else
+				dectmon_cluster_stop(cl);
+			break;
+		}
+		list_del(&req->list);
+		free(req->name);
+		free(req);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct dectmon_cluster *cl, *next;
+	const char *logname = NULL;
+	unsigned long log_rotate = 0;
+	const char *ctlpath = NULL;
+	bool headless = false;
 	int optidx = 0, c;
 
 	for (;;) {
@@ -276,7 +628,7 @@ int main(int argc, char **argv)
 
 		switch (c) {
 		case OPT_CLUSTER:
-			cluster[ncluster++] = optarg;
+			dectmon_cluster_attach(optarg);
 			break;
 		case OPT_SCAN:
 			scan = true;
@@ -290,22 +642,63 @@ int main(int argc, char **argv)
 		case OPT_DUMP_NWK:
 			dumpopts = opt_yesno(optarg, dumpopts, DECTMON_DUMP_NWK);
 			break;
+		case OPT_HEXDUMP:
+			dumpopts = opt_yesno(optarg, dumpopts, DECTMON_DUMP_HEX);
+			break;
 		case OPT_AUDIO:
 			dumpopts = opt_yesno(optarg, dumpopts, DECTMON_DUMP_AUDIO);
 			break;
+		case OPT_RECORD:
+			if (access(optarg, W_OK) < 0)
+				pexit("record directory");
+			dect_record_dir = optarg;
+			break;
+		case OPT_RECORD_FMT:
+			if (dect_record_parse_format(optarg) < 0)
+				pexit("invalid record format\n");
+			break;
+		case OPT_SILENCE:
+			dect_record_skip_silence = !opt_yesno(optarg, 0, 1);
+			break;
+		case OPT_STREAM:
+			if (dect_rtp_init(optarg) < 0)
+				pexit("invalid stream destination\n");
+			break;
 		case OPT_AUTH_PIN:
 			auth_pin = optarg;
 			break;
 		case OPT_LOGFILE:
-			logfile = fopen(optarg, "a");
-			if (logfile == NULL)
-				pexit("fopen");
+			logname = optarg;
+			break;
+		case OPT_LOG_ROTATE:
+			log_rotate = strtoul(optarg, NULL, 10) * 1024;
 			break;
 		case OPT_DUMPFILE:
 			dumpfile = fopen(optarg, "w");
 			if (dumpfile == NULL)
 				pexit("fopen");
 			break;
+		case OPT_EVLOG:
+			if (dect_evlog_open(optarg) < 0)
+				pexit("dect_evlog_open");
+			break;
+		case OPT_CDR:
+			if (dect_cdr_open(optarg) < 0)
+				pexit("dect_cdr_open");
+			break;
+		case OPT_TRACE:
+			dect_trace_enabled = opt_yesno(optarg, 0, 1);
+			break;
+		case OPT_HEADLESS:
+			headless = true;
+			break;
+		case OPT_CONTROL:
+			ctlpath = optarg;
+			headless = true;
+			break;
+		case OPT_PIN_CPU:
+			dectmon_cpu = atoi(optarg);
+			break;
 		case OPT_HELP:
 			dectmon_help(argv[0]);
 			exit(0);
@@ -315,37 +708,44 @@ int main(int argc, char **argv)
 		}
 	}
 
+	if (logname != NULL && dectmon_log_open(logname, log_rotate) < 0)
+		pexit("fopen");
+
 	dect_event_ops_init(&ops);
 	dect_dummy_ops_init(&ops);
-
-	if (dumpopts & DECTMON_DUMP_AUDIO)
-		dect_audio_init();
-
-	cli_init(stdin);
+	dect_evlog_init();
+
+	if (headless) {
+		if (cli_init_headless(ctlpath) < 0)
+			pexit("control socket");
+	} else
+		cli_init(stdin);
+	if (dectmon_log_init() < 0)
+		pexit("dectmon_log_init");
 	dect_set_debug_hook(dect_debug);
 
-	if (ncluster == 0)
-		ncluster = 1;
+	if (dect_keystore_init() < 0)
+		dectmon_log("failed to open key store: %s\n", strerror(errno));
 
-	for (i = 0; i < ncluster; i++) {
-		dh = dectmon_open_handle(&ops, cluster[i]);
-		priv = dect_handle_priv(dh);
+	if ((dumpopts & DECTMON_DUMP_AUDIO || dect_record_dir != NULL ||
+	     dect_rtp_dest != NULL) &&
+	    dect_audio_init(dumpopts & DECTMON_DUMP_AUDIO) < 0)
+		dectmon_log("failed to initialize audio\n");
 
-		priv->rawsk = dect_raw_open(dh);
-		if (priv->rawsk == NULL)
-			pexit("dect_raw_socket");
-
-		if (scan)
-			dect_llme_scan_req(dh);
-	}
+	if (list_empty(&dectmon_cluster_reqs))
+		dectmon_cluster_attach(NULL);
+	dectmon_cluster_commit();
 
 	dect_event_loop();
 
-	list_for_each_entry_safe(priv, next, &dect_handles, list) {
-		dect_raw_close(priv->dh, priv->rawsk);
-		dectmon_close_handle(priv);
-	}
+	list_for_each_entry_safe(cl, next, &dectmon_clusters, list)
+		dectmon_cluster_stop(cl);
 
+	dect_audio_exit();
+	dect_keystore_exit();
+	dect_cdr_close();
+	dect_evlog_close();
+	dectmon_log_exit();
 	cli_exit();
 	return 0;
 }
@@ -10,61 +10,21 @@
 
 #include <stdlib.h>
 #include <stdio.h>
-#include <limits.h>
+#include <time.h>
 
 #include <dect/libdect.h>
 #include <dect/s_fmt.h>
 #include <dectmon.h>
+#include <utils.h>
+#include <mac.h>
 #include <audio.h>
+#include <record.h>
+#include <rtp.h>
 #include <nwk.h>
-
-static const char * const nwk_msg_types[256] = {
-	[DECT_LCE_PAGE_RESPONSE]			= "LCE-PAGE-RESPONSE",
-	[DECT_LCE_PAGE_REJECT]				= "LCE-PAGE-REJECT",
-	[DECT_CC_ALERTING]				= "CC-ALERTING",
-	[DECT_CC_CALL_PROC]				= "CC-CALL-PROC",
-	[DECT_CC_SETUP]					= "CC-SETUP",
-	[DECT_CC_CONNECT]				= "CC-CONNECT",
-	[DECT_CC_SETUP_ACK]				= "CC-SETUP-ACK",
-	[DECT_CC_CONNECT_ACK]				= "CC-CONNECT-ACK",
-	[DECT_CC_SERVICE_CHANGE]			= "CC-SERVICE-CHANGE",
-	[DECT_CC_SERVICE_ACCEPT]			= "CC-SERVICE-ACCEPT",
-	[DECT_CC_SERVICE_REJECT]			= "CC-SERVICE-REJECT",
-	[DECT_CC_RELEASE]				= "CC-RELEASE",
-	[DECT_CC_RELEASE_COM]				= "CC-RELEASE-COM",
-	[DECT_CC_IWU_INFO]				= "CC-IWU-INFO",
-	[DECT_CC_NOTIFY]				= "CC-NOTIFY",
-	[DECT_CC_INFO]					= "CC-INFO",
-	[DECT_CISS_FACILITY]				= "CISS-FACILITY",
-	[DECT_CISS_REGISTER]				= "CISS-REGISTER",
-	[DECT_MM_AUTHENTICATION_REQUEST]		= "MM-AUTHENTICATION-REQUEST",
-	[DECT_MM_AUTHENTICATION_REPLY]			= "MM-AUTHENTICATION-REPLY",
-	[DECT_MM_KEY_ALLOCATE]				= "MM-KEY-ALLOCATE",
-	[DECT_MM_AUTHENTICATION_REJECT]			= "MM-AUTHENTICATION-REJECT",
-	[DECT_MM_ACCESS_RIGHTS_REQUEST]			= "MM-ACCESS-RIGHTS-REQUEST",
-	[DECT_MM_ACCESS_RIGHTS_ACCEPT]			= "MM-ACCESS-RIGHTS-ACCEPT",
-	[DECT_MM_ACCESS_RIGHTS_REJECT]			= "MM-ACCESS-RIGHTS-REJECT",
-	[DECT_MM_ACCESS_RIGHTS_TERMINATE_REQUEST]	= "MM-ACCESS-RIGHTS-TERMINATE-REQUEST",
-	[DECT_MM_ACCESS_RIGHTS_TERMINATE_ACCEPT]	= "MM-ACCESS-RIGHTS-TERMINATE-ACCEPT",
-	[DECT_MM_ACCESS_RIGHTS_TERMINATE_REJECT]	= "MM-ACCESS-RIGHTS-TERMINATE-REJECT",
-	[DECT_MM_CIPHER_REQUEST]			= "MM-CIPHER-REQUEST",
-	[DECT_MM_CIPHER_SUGGEST]			= "MM-CIPHER-SUGGEST",
-	[DECT_MM_CIPHER_REJECT]				= "MM-CIPHER-REJECT",
-	[DECT_MM_INFO_REQUEST]				= "MM-INFO-REQUEST",
-	[DECT_MM_INFO_ACCEPT]				= "MM-INFO-ACCEPT",
-	[DECT_MM_INFO_SUGGEST]				= "MM-INFO-SUGGEST",
-	[DECT_MM_INFO_REJECT]				= "MM-INFO-REJECT",
-	[DECT_MM_LOCATE_REQUEST]			= "MM-LOCATE-REQUEST",
-	[DECT_MM_LOCATE_ACCEPT]				= "MM-LOCATE-ACCEPT",
-	[DECT_MM_DETACH]				= "MM-DETACH",
-	[DECT_MM_LOCATE_REJECT]				= "MM-LOCATE-REJECT",
-	[DECT_MM_IDENTITY_REQUEST]			= "MM-IDENTITY-REQUEST",
-	[DECT_MM_IDENTITY_REPLY]			= "MM-IDENTITY-REPLY",
-	[DECT_MM_IWU]					= "MM-IWU",
-	[DECT_MM_TEMPORARY_IDENTITY_ASSIGN]		= "MM-TEMPORARY-IDENTITY-ASSIGN",
-	[DECT_MM_TEMPORARY_IDENTITY_ASSIGN_ACK]		= "MM-TEMPORARY-IDENTITY-ASSIGN-ACK",
-	[DECT_MM_TEMPORARY_IDENTITY_ASSIGN_REJ]		= "MM-TEMPORARY-IDENTITY-ASSIGN-REJ",
-};
+#include <trace.h>
+#include <evlog.h>
+#include <keystore.h>
+#include <cdr.h>
 
 #define dect_ie_release(dh, ie) 		\
 	do { 					\
@@ -73,139 +33,277 @@ static const char * const nwk_msg_types[256] = {
 		ie = NULL;			\
 	} while (0)
 
-static FILE *dect_keyfile_open(const char *mode)
-{
-	char name[PATH_MAX];
-
-	snprintf(name, sizeof(name), "%s/%s", getenv("HOME"), "dectmon.keys");
-	return fopen(name, mode);
-}
-
 static void dect_pt_write_uak(const struct dect_pt *pt)
 {
-	char ipei[DECT_IPEI_STRING_LEN + 1];
-	unsigned int i;
-	FILE *f;
-
-	f = dect_keyfile_open("w");
-	if (f == NULL)
+	if (pt->portable_identity->ipui.put != DECT_IPUI_N)
 		return;
-	dect_format_ipei_string(&pt->portable_identity->ipui.pun.n.ipei, ipei);
-
-	fprintf(f, "%s|", ipei);
-	for (i = 0; i < DECT_AUTH_KEY_LEN; i++)
-		fprintf(f, "%02x", pt->uak[i]);
-	fprintf(f, "\n");
-
-	fclose(f);
+	dect_keystore_update(&pt->portable_identity->ipui.pun.n.ipei, pt->uak);
 }
 
 static void dect_pt_read_uak(struct dect_pt *pt)
 {
-	char ipei[DECT_IPEI_STRING_LEN + 1];
-	uint8_t uak[DECT_AUTH_KEY_LEN];
-	struct dect_ipui ipui;
-	unsigned int i;
-	FILE *f;
+	const struct dect_ipui *ipui = &pt->portable_identity->ipui;
 
-	f = dect_keyfile_open("r");
-	if (f == NULL)
+	if (ipui->put != DECT_IPUI_N)
 		return;
+	dect_keystore_lookup(&ipui->pun.n.ipei, pt->uak);
+}
 
-	if (fscanf(f, "%13s|", ipei) != 1)
-		goto err;
-
-	for (i = 0; i < DECT_AUTH_KEY_LEN; i++) {
-		if (fscanf(f, "%02hhx", &uak[i]) != 1)
-			goto err;
-	}
+static time_t dect_pt_now(void)
+{
+	struct timespec ts;
 
-	memset(&ipui, 0, sizeof(ipui));
-	ipui.put = DECT_IPUI_N;
-	if (!dect_parse_ipei_string(&ipui.pun.n.ipei, ipei))
-		goto err;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec;
+}
 
-	if (dect_ipui_cmp(&ipui, &pt->portable_identity->ipui))
-		goto err;
+/* Only IPEIs are hashed by value, other IPUI types share a chain per type */
+static unsigned int dect_pt_hash(const struct dect_ipui *ipui)
+{
+	uint64_t key = ipui->put;
 
-	memcpy(pt->uak, uak, sizeof(pt->uak));
-err:
-	fclose(f);
+	if (ipui->put == DECT_IPUI_N)
+		key = (uint64_t)ipui->pun.n.ipei.emc << 32 | ipui->pun.n.ipei.psn;
+	return (key * 0x9e3779b97f4a7c15ULL) >> (64 - DECT_PT_HASH_BITS);
 }
 
 static struct dect_pt *dect_pt_lookup(struct dect_handle *dh,
 				      struct dect_ie_portable_identity *portable_identity)
 {
 	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	const struct dect_ipui *ipui = &portable_identity->ipui;
+	struct hlist_node *n;
 	struct dect_pt *pt;
 
-	list_for_each_entry(pt, &priv->pt_list, list) {
-		if (!dect_ipui_cmp(&pt->portable_identity->ipui,
-				   &portable_identity->ipui))
+	hlist_for_each_entry(pt, n, &priv->pt_hash[dect_pt_hash(ipui)], hnode) {
+		if (!dect_ipui_cmp(&pt->portable_identity->ipui, ipui)) {
+			list_move_tail(&pt->list, &priv->pt_list);
+			pt->last_seen = dect_pt_now();
 			return pt;
+		}
 	}
 	return NULL;
 }
 
+static void dect_pt_free(struct dect_handle *dh, struct dect_pt *pt)
+{
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+
+	if (pt->ah != NULL)
+		dect_audio_close(pt->ah);
+	dect_cdr_release(dh, pt, DECT_CDR_CAUSE_EXPIRE);
+
+	if (dect_timer_running(pt->release_timer)) {
+		dect_timer_stop(dh, pt->release_timer);
+		list_del(&pt->release_list);
+	}
+	dect_timer_free(dh, pt->release_timer);
+
+	dect_ie_release(dh, pt->auth_type);
+	dect_ie_release(dh, pt->rand_f);
+	dect_ie_release(dh, pt->rs);
+	dect_ie_release(dh, pt->res);
+	dect_ie_release(dh, pt->portable_identity);
+
+	list_del(&pt->list);
+	hlist_del(&pt->hnode);
+	priv->npt--;
+	free(pt);
+}
+
+/*
+ * Expire PTs from the head of the LRU list. PTs in use by a bearer are
+ * skipped, the walk ends at the first PT which is neither expired nor
+ * exceeding the limit.
+ */
+static void dect_pt_expire(struct dect_handle *dh, time_t now)
+{
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	struct dect_pt *pt, *next;
+
+	list_for_each_entry_safe(pt, next, &priv->pt_list, list) {
+		if (priv->npt < DECT_PT_MAX &&
+		    now - pt->last_seen < DECT_PT_TIMEOUT)
+			break;
+		if (pt->use)
+			continue;
+		dect_pt_free(dh, pt);
+	}
+}
+
+static void dect_pt_release_timer(struct dect_handle *dh,
+				  struct dect_timer *timer)
+{
+	struct dect_pt *pt = dect_timer_data(timer);
+
+	list_del(&pt->release_list);
+	if (pt->ah != NULL) {
+		dect_audio_close(pt->ah);
+		pt->ah = NULL;
+	}
+	dect_cdr_release(dh, pt, DECT_CDR_CAUSE_BEARER);
+}
+
 static struct dect_pt *dect_pt_init(struct dect_handle *dh,
 				    struct dect_ie_portable_identity *portable_identity)
 {
 	struct dect_handle_priv *priv = dect_handle_priv(dh);
 	struct dect_pt *pt;
+	time_t now = dect_pt_now();
+
+	dect_pt_expire(dh, now);
 
 	pt = calloc(1, sizeof(*pt));
 	if (pt == NULL)
 		return NULL;
 
+	pt->release_timer = dect_timer_alloc(dh);
+	if (pt->release_timer == NULL) {
+		free(pt);
+		return NULL;
+	}
+	dect_timer_setup(pt->release_timer, dect_pt_release_timer, pt);
+
 	pt->portable_identity = dect_ie_hold(portable_identity);
+	pt->last_seen = now;
 	list_add_tail(&pt->list, &priv->pt_list);
+	hlist_add_head(&pt->hnode,
+		       &priv->pt_hash[dect_pt_hash(&portable_identity->ipui)]);
+	priv->npt++;
 
+	pt->codec = dect_codec_lookup(DECT_CODEC_G726_32KBIT);
 	dect_pt_read_uak(pt);
 	return pt;
 }
 
-static void dect_pt_track_key_allocation(struct dect_handle *dh,
-					 struct dect_pt *pt, uint8_t msgtype,
-					 const struct dect_sfmt_ie *ie,
-					 struct dect_ie_common *common)
+void dect_pt_flush(struct dect_handle *dh)
 {
-	uint8_t k[DECT_AUTH_KEY_LEN], ks[DECT_AUTH_KEY_LEN];
-	uint8_t dck[DECT_CIPHER_KEY_LEN];
-	uint8_t ac[DECT_AUTH_CODE_LEN];
-	uint32_t res1;
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	struct dect_pt *pt, *next;
 
-	switch (msgtype) {
-	case DECT_MM_KEY_ALLOCATE:
-		if (pt->procedure != DECT_MM_NONE &&
-		    pt->procedure != DECT_MM_KEY_ALLOCATION)
-			return;
+	list_for_each_entry_safe(pt, next, &priv->pt_list, list)
+		dect_pt_free(dh, pt);
+}
 
-		if (ie->id == DECT_IE_RS)
-			pt->rs =	(void *)__dect_ie_hold(common);
-		if (ie->id == DECT_IE_RAND)
-			pt->rand_f =	(void *)__dect_ie_hold(common);
+/*
+ * Drop the reference of @dl to its PT. The call of a PT losing its last
+ * bearer is ended unless a new bearer is established within
+ * DECT_CDR_BEARER_GRACE seconds, the PT is kept on the release list
+ * until then.
+ */
+static void dect_dl_put_pt(struct dect_handle *dh, struct dect_dl *dl)
+{
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	struct dect_pt *pt = dl->pt;
+
+	if (pt->dl == dl)
+		pt->dl = NULL;
+	if (--pt->use == 0 && (pt->cdr != NULL || pt->ah != NULL)) {
+		dect_cdr_bearer_lost(pt);
+		dect_timer_start(dh, pt->release_timer, DECT_CDR_BEARER_GRACE);
+		list_add_tail(&pt->release_list, &priv->pt_release_list);
+	}
+	dl->pt = NULL;
+}
 
-		pt->procedure = DECT_MM_KEY_ALLOCATION;
-		pt->last_msg  = msgtype;
+static void dect_dl_set_pt(struct dect_handle *dh, struct dect_dl *dl,
+			   struct dect_pt *pt)
+{
+	if (dl->pt == pt)
 		return;
-	case DECT_MM_AUTHENTICATION_REQUEST:
-		if (pt->procedure != DECT_MM_KEY_ALLOCATION ||
-		    (pt->last_msg != DECT_MM_KEY_ALLOCATE &&
-		     pt->last_msg != DECT_MM_AUTHENTICATION_REQUEST))
-			return;
+	if (dl->pt != NULL)
+		dect_dl_put_pt(dh, dl);
+	dl->pt = pt;
+	pt->dl = dl;
+	if (pt->use++ == 0 && dect_timer_running(pt->release_timer)) {
+		dect_timer_stop(dh, pt->release_timer);
+		list_del(&pt->release_list);
+	}
 
-		if (ie->id == DECT_IE_RES)
-			pt->res =	(void *)__dect_ie_hold(common);
+	if (dl->tbc != NULL) {
+		pt->pmid = dl->tbc->pmid;
+		dect_cdr_bearer(pt, dl->tbc);
+	}
+}
 
-		pt->last_msg = msgtype;
+/*
+ * Called by the MAC layer when the bearer owning @dl is established. The
+ * PMID stays the same during bearer handover, so the new bearer belongs to
+ * the PT using the same PMID on another bearer or on the release list.
+ */
+void dect_dl_establish(struct dect_handle *dh, struct dect_dl *dl)
+{
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	const struct dect_tbc *tbc;
+	struct dect_pt *pt;
+	unsigned int i;
+
+	for (i = 0; i < array_size(priv->slots); i++) {
+		tbc = priv->slots[i];
+		if (tbc == NULL || tbc == dl->tbc || tbc->dl.pt == NULL ||
+		    tbc->pmid != dl->tbc->pmid)
+			continue;
+		dect_dl_set_pt(dh, dl, tbc->dl.pt);
+		return;
+	}
+
+	list_for_each_entry(pt, &priv->pt_release_list, release_list) {
+		if (pt->pmid != dl->tbc->pmid)
+			continue;
+		dect_dl_set_pt(dh, dl, pt);
+		return;
+	}
+}
+
+/* Called by the MAC layer when the bearer owning @dl is released */
+void dect_dl_release(struct dect_handle *dh, struct dect_dl *dl)
+{
+	if (dl->pt != NULL)
+		dect_dl_put_pt(dh, dl);
+}
+
+#define dect_pt_hold_ie(dh, ie, common)				\
+	do {								\
+		dect_ie_release(dh, ie);				\
+		ie = (void *)__dect_ie_hold(common);			\
+	} while (0)
+
+static void dect_pt_release_procedure(struct dect_handle *dh,
+				      struct dect_pt *pt)
+{
+	dect_ie_release(dh, pt->auth_type);
+	dect_ie_release(dh, pt->rs);
+	dect_ie_release(dh, pt->rand_f);
+	dect_ie_release(dh, pt->res);
+	pt->procedure = DECT_MM_NONE;
+}
+
+static void dect_pt_abort_procedure(struct dect_handle *dh, struct dect_pt *pt)
+{
+	switch (pt->procedure) {
+	case DECT_MM_KEY_ALLOCATION:
+		dectmon_log("unexpected message during key allocation\n");
+		break;
+	case DECT_MM_AUTHENTICATION:
+		dectmon_log("unexpected message during authentication\n");
 		break;
 	default:
-		if (pt->procedure == DECT_MM_KEY_ALLOCATION) {
-			dectmon_log("unexpected message during key allocation\n");
-			goto release;
-		}
-		return;
+		break;
 	}
+	dect_pt_release_procedure(dh, pt);
+}
+
+/*
+ * Key allocation
+ */
+
+static void dect_pt_key_allocation_complete(struct dect_handle *dh,
+					    struct dect_pt *pt)
+{
+	uint8_t k[DECT_AUTH_KEY_LEN], ks[DECT_AUTH_KEY_LEN];
+	uint8_t dck[DECT_CIPHER_KEY_LEN];
+	uint8_t ac[DECT_AUTH_CODE_LEN];
+	uint32_t res1;
 
 	if (pt->rs == NULL || pt->rand_f == NULL ||
 	    pt->res == NULL)
@@ -232,53 +330,36 @@ static void dect_pt_track_key_allocation(struct dect_handle *dh,
 	} else
 		dectmon_log("authentication failed\n");
 
-release:
-	dect_ie_release(dh, pt->rs);
-	dect_ie_release(dh, pt->rand_f);
-	dect_ie_release(dh, pt->res);
-	pt->procedure = DECT_MM_NONE;
+	dect_pt_release_procedure(dh, pt);
 }
 
-static void dect_pt_track_auth(struct dect_handle *dh,
-			       struct dect_pt *pt, uint8_t msgtype,
-			       const struct dect_sfmt_ie *ie,
-			       struct dect_ie_common *common)
+static void dect_mm_key_allocate_ie(struct dect_handle *dh, struct dect_pt *pt,
+				    uint8_t msgtype, const struct dect_sfmt_ie *ie,
+				    struct dect_ie_common *common)
 {
-	uint8_t k[DECT_AUTH_KEY_LEN], ks[DECT_AUTH_KEY_LEN];
-	uint8_t dck[DECT_CIPHER_KEY_LEN];
-	struct dect_ie_auth_res res1;
-
-	switch (msgtype) {
-	case DECT_MM_AUTHENTICATION_REQUEST:
-		if (pt->procedure != DECT_MM_NONE &&
-		    pt->procedure != DECT_MM_AUTHENTICATION)
-			return;
+	if (ie->id == DECT_IE_RS)
+		dect_pt_hold_ie(dh, pt->rs, common);
+	if (ie->id == DECT_IE_RAND)
+		dect_pt_hold_ie(dh, pt->rand_f, common);
+}
 
-		if (ie->id == DECT_IE_AUTH_TYPE)
-			pt->auth_type = (void *)__dect_ie_hold(common);
-		if (ie->id == DECT_IE_RS)
-			pt->rs =	(void *)__dect_ie_hold(common);
-		if (ie->id == DECT_IE_RAND)
-			pt->rand_f =	(void *)__dect_ie_hold(common);
+static void dect_mm_key_allocate(struct dect_handle *dh, struct dect_pt *pt,
+				 uint8_t msgtype)
+{
+	pt->procedure = DECT_MM_KEY_ALLOCATION;
+	pt->last_msg  = msgtype;
+}
 
-		pt->procedure = DECT_MM_AUTHENTICATION;
-		pt->last_msg  = msgtype;
-		return;
-	case DECT_MM_AUTHENTICATION_REPLY:
-		if (pt->procedure != DECT_MM_AUTHENTICATION ||
-		    pt->last_msg != DECT_MM_AUTHENTICATION_REQUEST)
-			return;
+/*
+ * Authentication
+ */
 
-		if (ie->id == DECT_IE_RES)
-			pt->res		= (void *)__dect_ie_hold(common);
-		break;
-	default:
-		if (pt->procedure == DECT_MM_AUTHENTICATION) {
-			dectmon_log("unexpected message during authentication\n");
-			goto release;
-		}
-		return;
-	}
+static void dect_pt_authentication_complete(struct dect_handle *dh,
+					    struct dect_pt *pt)
+{
+	uint8_t k[DECT_AUTH_KEY_LEN], ks[DECT_AUTH_KEY_LEN];
+	uint8_t dck[DECT_CIPHER_KEY_LEN];
+	struct dect_ie_auth_res res1;
 
 	if (pt->auth_type == NULL || pt->rs == NULL || pt->rand_f == NULL ||
 	    pt->res == NULL)
@@ -298,86 +379,402 @@ static void dect_pt_track_auth(struct dect_handle *dh,
 	} else
 		dectmon_log("authentication failed\n");
 
-release:
-	dect_ie_release(dh, pt->auth_type);
-	dect_ie_release(dh, pt->rs);
-	dect_ie_release(dh, pt->rand_f);
-	dect_ie_release(dh, pt->res);
-	pt->procedure = DECT_MM_NONE;
+	dect_pt_release_procedure(dh, pt);
 }
 
-static void dect_pt_track_ciphering(struct dect_handle *dh,
-				    struct dect_pt *pt, uint8_t msgtype,
-				    const struct dect_sfmt_ie *ie,
-				    struct dect_ie_common *common)
+/* During key allocation the PT authenticates itself to the FP */
+static bool dect_pt_key_allocation_auth(const struct dect_pt *pt)
+{
+	return pt->procedure == DECT_MM_KEY_ALLOCATION &&
+	       (pt->last_msg == DECT_MM_KEY_ALLOCATE ||
+		pt->last_msg == DECT_MM_AUTHENTICATION_REQUEST);
+}
+
+static void dect_mm_authentication_request_ie(struct dect_handle *dh,
+					      struct dect_pt *pt, uint8_t msgtype,
+					      const struct dect_sfmt_ie *ie,
+					      struct dect_ie_common *common)
+{
+	if (pt->procedure == DECT_MM_KEY_ALLOCATION) {
+		if (dect_pt_key_allocation_auth(pt) && ie->id == DECT_IE_RES)
+			dect_pt_hold_ie(dh, pt->res, common);
+		return;
+	}
+
+	if (ie->id == DECT_IE_AUTH_TYPE)
+		dect_pt_hold_ie(dh, pt->auth_type, common);
+	if (ie->id == DECT_IE_RS)
+		dect_pt_hold_ie(dh, pt->rs, common);
+	if (ie->id == DECT_IE_RAND)
+		dect_pt_hold_ie(dh, pt->rand_f, common);
+}
+
+static void dect_mm_authentication_request(struct dect_handle *dh,
+					   struct dect_pt *pt, uint8_t msgtype)
 {
-	switch (msgtype) {
-	case DECT_MM_CIPHER_REQUEST:
-		if (pt->procedure != DECT_MM_NONE)
+	if (pt->procedure == DECT_MM_KEY_ALLOCATION) {
+		if (!dect_pt_key_allocation_auth(pt))
 			return;
+		pt->last_msg = msgtype;
+		dect_pt_key_allocation_complete(dh, pt);
+		return;
+	}
+
+	pt->procedure = DECT_MM_AUTHENTICATION;
+	pt->last_msg  = msgtype;
+}
+
+static void dect_mm_authentication_reply_ie(struct dect_handle *dh,
+					    struct dect_pt *pt, uint8_t msgtype,
+					    const struct dect_sfmt_ie *ie,
+					    struct dect_ie_common *common)
+{
+	if (pt->procedure != DECT_MM_AUTHENTICATION ||
+	    pt->last_msg != DECT_MM_AUTHENTICATION_REQUEST)
+		return;
+
+	if (ie->id == DECT_IE_RES)
+		dect_pt_hold_ie(dh, pt->res, common);
+}
+
+static void dect_mm_authentication_reply(struct dect_handle *dh,
+					 struct dect_pt *pt, uint8_t msgtype)
+{
+	if (pt->procedure != DECT_MM_AUTHENTICATION ||
+	    pt->last_msg != DECT_MM_AUTHENTICATION_REQUEST)
+		return;
+
+	dect_pt_authentication_complete(dh, pt);
+}
+
+/*
+ * Ciphering
+ */
+
+static void dect_mm_cipher_request(struct dect_handle *dh, struct dect_pt *pt,
+				   uint8_t msgtype)
+{
+	if (pt->procedure != DECT_MM_NONE)
+		return;
+	if (pt->dl != NULL && pt->dl->tbc != NULL)
 		pt->dl->tbc->ciphered = true;
-		break;
-	default:
+}
+
+/*
+ * Calls
+ */
+
+static void dect_pt_audio_open(struct dect_handle *dh, struct dect_pt *pt)
+{
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	struct dect_audio_sink *sink;
+
+	if (pt->ah != NULL ||
+	    (!(dumpopts & DECTMON_DUMP_AUDIO) && dect_record_dir == NULL &&
+	     dect_rtp_dest == NULL))
+		return;
+
+	pt->ah = dect_audio_open();
+	if (pt->ah == NULL)
 		return;
+
+	if (dumpopts & DECTMON_DUMP_AUDIO &&
+	    (sink = dect_audio_mixer_open()) != NULL)
+		dect_audio_add_sink(pt->ah, sink);
+	if (dect_record_dir != NULL &&
+	    (sink = dect_record_open(priv->cluster, pt)) != NULL)
+		dect_audio_add_sink(pt->ah, sink);
+	if (dect_rtp_dest != NULL &&
+	    (sink = dect_rtp_open()) != NULL)
+		dect_audio_add_sink(pt->ah, sink);
+}
+
+/*
+ * The basic service selects between narrowband (G.726) and wideband (G.722)
+ * speech, a codec list overrides it. The portable offers its preferred codec
+ * first, the fixed part answers with the selected one. During a service
+ * change the new codec only takes effect once it has been accepted.
+ */
+static void dect_pt_set_codec(struct dect_pt *pt, uint8_t msgtype,
+			      enum dect_codecs codec)
+{
+	if (msgtype == DECT_CC_SERVICE_CHANGE)
+		pt->codec_pending = dect_codec_lookup(codec);
+	else {
+		pt->codec = dect_codec_lookup(codec);
+		pt->codec_pending = NULL;
 	}
 }
 
-static void dect_pt_track_audio(struct dect_handle *dh,
-				struct dect_pt *pt, uint8_t msgtype,
-				const struct dect_sfmt_ie *ie,
-				struct dect_ie_common *common)
+static void dect_cc_ie(struct dect_handle *dh, struct dect_pt *pt,
+		       uint8_t msgtype, const struct dect_sfmt_ie *ie,
+		       struct dect_ie_common *common)
 {
 	struct dect_ie_progress_indicator *progress_indicator;
+	struct dect_ie_basic_service *basic_service;
+	struct dect_ie_codec_list *codec_list;
+	struct dect_ie_keypad *keypad;
 
-	switch (msgtype) {
-	case DECT_CC_SETUP:
-	case DECT_CC_SETUP_ACK:
-	case DECT_CC_CALL_PROC:
-	case DECT_CC_INFO:
-	case DECT_CC_ALERTING:
-		if (ie->id != DECT_IE_PROGRESS_INDICATOR)
-			break;
+	switch (ie->id) {
+	case DECT_IE_PROGRESS_INDICATOR:
 		progress_indicator = (void *)common;
-		if (progress_indicator->progress !=
+		if (progress_indicator->progress ==
 		    DECT_PROGRESS_INBAND_INFORMATION_NOW_AVAILABLE)
-			break;
-		/* fall through */
-	case DECT_CC_CONNECT:
-		if (dumpopts & DECTMON_DUMP_AUDIO &&
-		    pt->ah == NULL)
-			pt->ah = dect_audio_open();
+			dect_pt_audio_open(dh, pt);
 		break;
-	case DECT_CC_RELEASE:
-	case DECT_CC_RELEASE_COM:
-		if (pt->ah != NULL) {
-			dect_audio_close(pt->ah);
-			pt->ah = NULL;
-		}
+	case DECT_IE_KEYPAD:
+	case DECT_IE_MULTI_KEYPAD:
+		keypad = (void *)common;
+		dect_cdr_keypad(pt, keypad->info, keypad->len);
+		break;
+	case DECT_IE_BASIC_SERVICE:
+		basic_service = (void *)common;
+		if (basic_service->service == DECT_SERVICE_WIDEBAND_SPEECH)
+			dect_pt_set_codec(pt, msgtype, DECT_CODEC_G722_64KBIT);
+		else if (basic_service->service ==
+			 DECT_SERVICE_BASIC_SPEECH_DEFAULT)
+			dect_pt_set_codec(pt, msgtype, DECT_CODEC_G726_32KBIT);
+		break;
+	case DECT_IE_CODEC_LIST:
+		codec_list = (void *)common;
+		if (codec_list->num > 0)
+			dect_pt_set_codec(pt, msgtype, codec_list->entry[0].codec);
 		break;
 	}
 }
 
+static void dect_cc_setup_ie(struct dect_handle *dh, struct dect_pt *pt,
+			     uint8_t msgtype, const struct dect_sfmt_ie *ie,
+			     struct dect_ie_common *common)
+{
+	dect_cdr_setup(pt);
+	dect_cc_ie(dh, pt, msgtype, ie, common);
+}
+
+static void dect_cc_setup(struct dect_handle *dh, struct dect_pt *pt,
+			  uint8_t msgtype)
+{
+	dect_cdr_setup(pt);
+}
+
+static void dect_cc_connect(struct dect_handle *dh, struct dect_pt *pt,
+			    uint8_t msgtype)
+{
+	dect_pt_audio_open(dh, pt);
+	dect_cdr_connect(pt);
+}
+
+static void dect_cc_service_accept(struct dect_handle *dh, struct dect_pt *pt,
+				   uint8_t msgtype)
+{
+	if (pt->codec_pending != NULL)
+		pt->codec = pt->codec_pending;
+	pt->codec_pending = NULL;
+}
+
+static void dect_cc_service_reject(struct dect_handle *dh, struct dect_pt *pt,
+				   uint8_t msgtype)
+{
+	pt->codec_pending = NULL;
+}
+
+static void dect_cc_release(struct dect_handle *dh, struct dect_pt *pt,
+			    uint8_t msgtype)
+{
+	if (pt->ah != NULL) {
+		dect_audio_close(pt->ah);
+		pt->ah = NULL;
+	}
+	pt->codec = dect_codec_lookup(DECT_CODEC_G726_32KBIT);
+	pt->codec_pending = NULL;
+	dect_cdr_release(dh, pt, DECT_CDR_CAUSE_RELEASE);
+}
+
+/*
+ * Message dispatch
+ */
+
+#define DECT_MM_PROCEDURE(p)	(1 << (p))
+
+/**
+ * struct dect_nwk_handler - NWK message handler
+ *
+ * @procedures:	MM procedures the message is part of, any other procedure
+ *		in progress is aborted
+ * @ies:	IEs passed to the IE handler, zero terminated
+ * @ie:		IE handler, called for each subscribed IE
+ * @msg:	message handler, called once all IEs have been processed
+ *
+ * Only subscribed IEs and the portable identity are decoded, other IEs
+ * are skipped based on their header unless NWK messages are dumped.
+ */
+struct dect_nwk_handler {
+	uint8_t			procedures;
+	uint8_t			ies[6];
+	void			(*ie)(struct dect_handle *dh, struct dect_pt *pt,
+				      uint8_t msgtype,
+				      const struct dect_sfmt_ie *ie,
+				      struct dect_ie_common *common);
+	void			(*msg)(struct dect_handle *dh, struct dect_pt *pt,
+				       uint8_t msgtype);
+};
+
+static const struct dect_nwk_handler dect_mm_key_allocate_handler = {
+	.procedures	= DECT_MM_PROCEDURE(DECT_MM_KEY_ALLOCATION),
+	.ies		= { DECT_IE_RS, DECT_IE_RAND },
+	.ie		= dect_mm_key_allocate_ie,
+	.msg		= dect_mm_key_allocate,
+};
+
+static const struct dect_nwk_handler dect_mm_authentication_request_handler = {
+	.procedures	= DECT_MM_PROCEDURE(DECT_MM_KEY_ALLOCATION) |
+			  DECT_MM_PROCEDURE(DECT_MM_AUTHENTICATION),
+	.ies		= { DECT_IE_AUTH_TYPE, DECT_IE_RS, DECT_IE_RAND, DECT_IE_RES },
+	.ie		= dect_mm_authentication_request_ie,
+	.msg		= dect_mm_authentication_request,
+};
+
+static const struct dect_nwk_handler dect_mm_authentication_reply_handler = {
+	.procedures	= DECT_MM_PROCEDURE(DECT_MM_AUTHENTICATION),
+	.ies		= { DECT_IE_RES },
+	.ie		= dect_mm_authentication_reply_ie,
+	.msg		= dect_mm_authentication_reply,
+};
+
+static const struct dect_nwk_handler dect_mm_cipher_request_handler = {
+	.msg		= dect_mm_cipher_request,
+};
+
+static const struct dect_nwk_handler dect_cc_setup_handler = {
+	.ies		= { DECT_IE_PROGRESS_INDICATOR, DECT_IE_KEYPAD,
+			    DECT_IE_MULTI_KEYPAD, DECT_IE_BASIC_SERVICE,
+			    DECT_IE_CODEC_LIST },
+	.ie		= dect_cc_setup_ie,
+	.msg		= dect_cc_setup,
+};
+
+static const struct dect_nwk_handler dect_cc_info_handler = {
+	.ies		= { DECT_IE_PROGRESS_INDICATOR, DECT_IE_KEYPAD,
+			    DECT_IE_MULTI_KEYPAD },
+	.ie		= dect_cc_ie,
+};
+
+static const struct dect_nwk_handler dect_cc_progress_handler = {
+	.ies		= { DECT_IE_PROGRESS_INDICATOR, DECT_IE_CODEC_LIST },
+	.ie		= dect_cc_ie,
+};
+
+static const struct dect_nwk_handler dect_cc_connect_handler = {
+	.ies		= { DECT_IE_PROGRESS_INDICATOR, DECT_IE_CODEC_LIST },
+	.ie		= dect_cc_ie,
+	.msg		= dect_cc_connect,
+};
+
+static const struct dect_nwk_handler dect_cc_service_change_handler = {
+	.ies		= { DECT_IE_BASIC_SERVICE, DECT_IE_CODEC_LIST },
+	.ie		= dect_cc_ie,
+};
+
+static const struct dect_nwk_handler dect_cc_service_accept_handler = {
+	.ies		= { DECT_IE_CODEC_LIST },
+	.ie		= dect_cc_ie,
+	.msg		= dect_cc_service_accept,
+};
+
+static const struct dect_nwk_handler dect_cc_service_reject_handler = {
+	.msg		= dect_cc_service_reject,
+};
+
+static const struct dect_nwk_handler dect_cc_release_handler = {
+	.msg		= dect_cc_release,
+};
+
+static const struct dect_nwk_handler *
+dect_nwk_handlers[DECT_PD_MAX + 1][256] = {
+	[DECT_PD_CC] = {
+		[DECT_CC_SETUP]				= &dect_cc_setup_handler,
+		[DECT_CC_SETUP_ACK]			= &dect_cc_progress_handler,
+		[DECT_CC_CALL_PROC]			= &dect_cc_progress_handler,
+		[DECT_CC_INFO]				= &dect_cc_info_handler,
+		[DECT_CC_ALERTING]			= &dect_cc_progress_handler,
+		[DECT_CC_CONNECT]			= &dect_cc_connect_handler,
+		[DECT_CC_SERVICE_CHANGE]		= &dect_cc_service_change_handler,
+		[DECT_CC_SERVICE_ACCEPT]		= &dect_cc_service_accept_handler,
+		[DECT_CC_SERVICE_REJECT]		= &dect_cc_service_reject_handler,
+		[DECT_CC_RELEASE]			= &dect_cc_release_handler,
+		[DECT_CC_RELEASE_COM]			= &dect_cc_release_handler,
+	},
+	[DECT_PD_MM] = {
+		[DECT_MM_KEY_ALLOCATE]			= &dect_mm_key_allocate_handler,
+		[DECT_MM_AUTHENTICATION_REQUEST]	= &dect_mm_authentication_request_handler,
+		[DECT_MM_AUTHENTICATION_REPLY]		= &dect_mm_authentication_reply_handler,
+		[DECT_MM_CIPHER_REQUEST]		= &dect_mm_cipher_request_handler,
+	},
+};
+
+static bool dect_nwk_ie_subscribed(const struct dect_nwk_handler *h,
+				   uint16_t id)
+{
+	unsigned int i;
+
+	if (h == NULL)
+		return false;
+	for (i = 0; i < array_size(h->ies) && h->ies[i] != 0; i++) {
+		if (h->ies[i] == id)
+			return true;
+	}
+	return false;
+}
+
+/* Abort MM procedures the message is not part of */
+static void dect_nwk_msg_start(struct dect_handle *dh, struct dect_pt *pt,
+			       const struct dect_nwk_handler *h)
+{
+	uint8_t procedures = h ? h->procedures : 0;
+
+	if (pt->procedure != DECT_MM_NONE &&
+	    !(procedures & DECT_MM_PROCEDURE(pt->procedure)))
+		dect_pt_abort_procedure(dh, pt);
+}
+
 void dect_dl_data_ind(struct dect_handle *dh, struct dect_dl *dl,
 		      struct dect_msg_buf *mb)
 {
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	const struct dect_nwk_handler *h;
 	struct dect_pt *pt;
 	struct dect_sfmt_ie ie;
 	struct dect_ie_common *common;
-	uint8_t msgtype;
+	uint8_t pd, msgtype;
+	bool started, dump;
 
-	if (!(dumpopts & DECTMON_DUMP_NWK))
-		return;
+	dect_evlog(nwk, priv->index, dl->tbc, mb);
 
+	pd	= mb->data[0] & DECT_PD_MASK;
 	msgtype = mb->data[1];
+	h	= pd <= DECT_PD_MAX ? dect_nwk_handlers[pd][msgtype] : NULL;
+	dump	= dumpopts & DECTMON_DUMP_NWK;
+
+	if (dump) {
+		dectmon_log("\n");
+		if (dumpopts & DECTMON_DUMP_HEX)
+			dect_hexdump("NWK", mb->data, mb->len);
+		dectmon_log("{%s} message:\n", nwk_msg_types[msgtype]);
+	}
 
-	dectmon_log("\n");
-	dect_hexdump("NWK", mb->data, mb->len);
-	dectmon_log("{%s} message:\n", nwk_msg_types[msgtype]);
+	started = dl->pt != NULL;
+	if (started)
+		dect_nwk_msg_start(dh, dl->pt, h);
 
 	dect_mbuf_pull(mb, 2);
 	while (mb->len) {
 		if (dect_parse_sfmt_ie_header(&ie, mb) < 0)
 			goto out;
+
+		if (ie.id != DECT_IE_PORTABLE_IDENTITY && !dump &&
+		    !(dl->pt != NULL && dect_nwk_ie_subscribed(h, ie.id)))
+			goto next;
+
 		if (dect_parse_sfmt_ie(dh, ie.id, &common, &ie) < 0)
 			goto out;
 
@@ -385,21 +782,27 @@ void dect_dl_data_ind(struct dect_handle *dh, struct dect_dl *dl,
 			pt = dect_pt_lookup(dh, (void *)common);
 			if (pt == NULL)
 				pt = dect_pt_init(dh, (void *)common);
-			dl->pt = pt;
-			pt->dl = dl;
+			if (pt != NULL)
+				dect_dl_set_pt(dh, dl, pt);
+			if (pt != NULL && !started) {
+				dect_nwk_msg_start(dh, pt, h);
+				started = true;
+			}
 		}
 
-		if (dl->pt != NULL) {
-			dect_pt_track_key_allocation(dh, dl->pt, msgtype, &ie, common);
-			dect_pt_track_auth(dh, dl->pt, msgtype, &ie, common);
-			dect_pt_track_ciphering(dh, dl->pt, msgtype, &ie, common);
-			dect_pt_track_audio(dh, dl->pt, msgtype, &ie, common);
-		}
+		if (dl->pt != NULL && h != NULL && h->ie != NULL &&
+		    dect_nwk_ie_subscribed(h, ie.id))
+			h->ie(dh, dl->pt, msgtype, &ie, common);
 
 		__dect_ie_put(dh, common);
+next:
 		dect_mbuf_pull(mb, ie.len);
 	}
+
+	if (dl->pt != NULL && h != NULL && h->msg != NULL)
+		h->msg(dh, dl->pt, msgtype);
 out:
+	dect_trace_stage(DECT_TRACE_NWK);
 	dect_mbuf_free(dh, mb);
 }
 
@@ -407,19 +810,21 @@ void dect_dl_u_data_ind(struct dect_handle *dh, struct dect_dl *dl, bool dir,
 			struct dect_msg_buf *mb)
 {
 	struct dect_pt *pt = dl->pt;
-	struct dect_msg_buf *clone;
+	const struct dect_codec *codec;
 
 	if (pt == NULL || pt->ah == NULL)
 		return;
 
-	/* Clone message buffer - audio is processed asynchronously, so we can't
-	 * use the on-stack buffer
-	 */
-	clone = dect_mbuf_alloc(dh);
-	if (clone == NULL)
+	/* Calls using a codec without decoder are not processed */
+	codec = pt->codec;
+	if (codec == NULL || mb->len < codec->frame_size)
+		return;
+
+	/* Only the first DECT_B_FIELD_SIZE octets are deciphered */
+	if (dl->tbc != NULL && dl->tbc->ciphered &&
+	    codec->frame_size > DECT_B_FIELD_SIZE)
 		return;
 
-	mb->len = 40;
-	memcpy(dect_mbuf_put(clone, mb->len), mb->data, mb->len);
-	dect_audio_queue(pt->ah, dir, clone);
+	dect_audio_queue(pt->ah, dir, DECT_AUDIO_SEQ(mb->mfn, mb->frame),
+			 codec, mb->data);
 }
@@ -0,0 +1,60 @@
+/*
+ * dectmon - NWK layer message names
+ *
+ * Copyright (c) 2010 Patrick McHardy <kaber@trash.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <nwk.h>
+
+const char * const nwk_msg_types[256] = {
+	[DECT_LCE_PAGE_RESPONSE]			= "LCE-PAGE-RESPONSE",
+	[DECT_LCE_PAGE_REJECT]				= "LCE-PAGE-REJECT",
+	[DECT_CC_ALERTING]				= "CC-ALERTING",
+	[DECT_CC_CALL_PROC]				= "CC-CALL-PROC",
+	[DECT_CC_SETUP]					= "CC-SETUP",
+	[DECT_CC_CONNECT]				= "CC-CONNECT",
+	[DECT_CC_SETUP_ACK]				= "CC-SETUP-ACK",
+	[DECT_CC_CONNECT_ACK]				= "CC-CONNECT-ACK",
+	[DECT_CC_SERVICE_CHANGE]			= "CC-SERVICE-CHANGE",
+	[DECT_CC_SERVICE_ACCEPT]			= "CC-SERVICE-ACCEPT",
+	[DECT_CC_SERVICE_REJECT]			= "CC-SERVICE-REJECT",
+	[DECT_CC_RELEASE]				= "CC-RELEASE",
+	[DECT_CC_RELEASE_COM]				= "CC-RELEASE-COM",
+	[DECT_CC_IWU_INFO]				= "CC-IWU-INFO",
+	[DECT_CC_NOTIFY]				= "CC-NOTIFY",
+	[DECT_CC_INFO]					= "CC-INFO",
+	[DECT_CISS_FACILITY]				= "CISS-FACILITY",
+	[DECT_CISS_REGISTER]				= "CISS-REGISTER",
+	[DECT_MM_AUTHENTICATION_REQUEST]		= "MM-AUTHENTICATION-REQUEST",
+	[DECT_MM_AUTHENTICATION_REPLY]			= "MM-AUTHENTICATION-REPLY",
+	[DECT_MM_KEY_ALLOCATE]				= "MM-KEY-ALLOCATE",
+	[DECT_MM_AUTHENTICATION_REJECT]			= "MM-AUTHENTICATION-REJECT",
+	[DECT_MM_ACCESS_RIGHTS_REQUEST]			= "MM-ACCESS-RIGHTS-REQUEST",
+	[DECT_MM_ACCESS_RIGHTS_ACCEPT]			= "MM-ACCESS-RIGHTS-ACCEPT",
+	[DECT_MM_ACCESS_RIGHTS_REJECT]			= "MM-ACCESS-RIGHTS-REJECT",
+	[DECT_MM_ACCESS_RIGHTS_TERMINATE_REQUEST]	= "MM-ACCESS-RIGHTS-TERMINATE-REQUEST",
+	[DECT_MM_ACCESS_RIGHTS_TERMINATE_ACCEPT]	= "MM-ACCESS-RIGHTS-TERMINATE-ACCEPT",
+	[DECT_MM_ACCESS_RIGHTS_TERMINATE_REJECT]	= "MM-ACCESS-RIGHTS-TERMINATE-REJECT",
+	[DECT_MM_CIPHER_REQUEST]			= "MM-CIPHER-REQUEST",
+	[DECT_MM_CIPHER_SUGGEST]			= "MM-CIPHER-SUGGEST",
+	[DECT_MM_CIPHER_REJECT]				= "MM-CIPHER-REJECT",
+	[DECT_MM_INFO_REQUEST]				= "MM-INFO-REQUEST",
+	[DECT_MM_INFO_ACCEPT]				= "MM-INFO-ACCEPT",
+	[DECT_MM_INFO_SUGGEST]				= "MM-INFO-SUGGEST",
+	[DECT_MM_INFO_REJECT]				= "MM-INFO-REJECT",
+	[DECT_MM_LOCATE_REQUEST]			= "MM-LOCATE-REQUEST",
+	[DECT_MM_LOCATE_ACCEPT]				= "MM-LOCATE-ACCEPT",
+	[DECT_MM_DETACH]				= "MM-DETACH",
+	[DECT_MM_LOCATE_REJECT]				= "MM-LOCATE-REJECT",
+	[DECT_MM_IDENTITY_REQUEST]			= "MM-IDENTITY-REQUEST",
+	[DECT_MM_IDENTITY_REPLY]			= "MM-IDENTITY-REPLY",
+	[DECT_MM_IWU]					= "MM-IWU",
+	[DECT_MM_TEMPORARY_IDENTITY_ASSIGN]		= "MM-TEMPORARY-IDENTITY-ASSIGN",
+	[DECT_MM_TEMPORARY_IDENTITY_ASSIGN_ACK]		= "MM-TEMPORARY-IDENTITY-ASSIGN-ACK",
+	[DECT_MM_TEMPORARY_IDENTITY_ASSIGN_REJ]		= "MM-TEMPORARY-IDENTITY-ASSIGN-REJ",
+};
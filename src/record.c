@@ -0,0 +1,247 @@
+/*
+ * dectmon call recording
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <endian.h>
+#include <time.h>
+
+#include <dect/libdect.h>
+#include <dectmon.h>
+#include <audio.h>
+#include <g711.h>
+#include <record.h>
+
+#define DECT_RECORD_BUFSIZE		65536
+#define DECT_RECORD_DEFAULT_RATE	8000
+
+const char *dect_record_dir;
+enum dect_record_formats dect_record_format = DECT_RECORD_PCM;
+bool dect_record_skip_silence;
+
+/* WAVE format tags and sample sizes */
+static const struct {
+	const char	*name;
+	uint16_t	tag;
+	uint16_t	size;
+} dect_record_formats[] = {
+	[DECT_RECORD_PCM]	= { "pcm",	1, sizeof(int16_t) },
+	[DECT_RECORD_ALAW]	= { "alaw",	6, sizeof(uint8_t) },
+	[DECT_RECORD_ULAW]	= { "ulaw",	7, sizeof(uint8_t) },
+};
+
+static const char * const dect_record_dir_names[] = {
+	[0]	= "pp",
+	[1]	= "fp",
+};
+
+int dect_record_parse_format(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < array_size(dect_record_formats); i++) {
+		if (!strcmp(dect_record_formats[i].name, name)) {
+			dect_record_format = i;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+static unsigned int dect_wav_chunk(uint8_t *buf, const char *id,
+				   uint32_t size)
+{
+	struct dect_wav_chunk *c = (struct dect_wav_chunk *)buf;
+
+	memcpy(c->id, id, sizeof(c->id));
+	c->size = htole32(size);
+	return sizeof(*c);
+}
+
+/*
+ * Build the WAVE header for the configured format. Its length only depends
+ * on the format, so the header can be rewritten once the number of
+ * samples is known.
+ */
+static unsigned int dect_wav_header_init(uint8_t *buf, unsigned int rate,
+					 uint32_t samples)
+{
+	unsigned int ssize = dect_record_formats[dect_record_format].size;
+	bool pcm = dect_record_format == DECT_RECORD_PCM;
+	uint32_t size = samples * ssize, fact = htole32(samples);
+	unsigned int len, fmt_size;
+	struct dect_wav_fmt fmt;
+
+	fmt_size = pcm ? offsetof(struct dect_wav_fmt, cb_size) : sizeof(fmt);
+	fmt.format	= htole16(dect_record_formats[dect_record_format].tag);
+	fmt.channels	= htole16(1);
+	fmt.rate	= htole32(rate);
+	fmt.byte_rate	= htole32(rate * ssize);
+	fmt.block_align	= htole16(ssize);
+	fmt.bits	= htole16(ssize * 8);
+	fmt.cb_size	= htole16(0);
+
+	len = sizeof(struct dect_wav_chunk);
+	memcpy(buf + len, "WAVE", 4);
+	len += 4;
+
+	len += dect_wav_chunk(buf + len, "fmt ", fmt_size);
+	memcpy(buf + len, &fmt, fmt_size);
+	len += fmt_size;
+
+	if (!pcm) {
+		len += dect_wav_chunk(buf + len, "fact", sizeof(fact));
+		memcpy(buf + len, &fact, sizeof(fact));
+		len += sizeof(fact);
+	}
+
+	/* Odd sized chunks are followed by a pad byte */
+	len += dect_wav_chunk(buf + len, "data", size);
+	dect_wav_chunk(buf, "RIFF",
+		       len - sizeof(struct dect_wav_chunk) + size + (size & 1));
+	return len;
+}
+
+static FILE *dect_record_create(const char *prefix, unsigned int dir)
+{
+	uint8_t h[DECT_WAV_HEADER_MAX_SIZE];
+	unsigned int len;
+	char name[PATH_MAX];
+	FILE *f;
+
+	snprintf(name, sizeof(name), "%s-%s.wav",
+		 prefix, dect_record_dir_names[dir]);
+	f = fopen(name, "w");
+	if (f == NULL)
+		return NULL;
+	setvbuf(f, NULL, _IOFBF, DECT_RECORD_BUFSIZE);
+
+	len = dect_wav_header_init(h, DECT_RECORD_DEFAULT_RATE, 0);
+	if (fwrite(h, len, 1, f) != 1) {
+		fclose(f);
+		return NULL;
+	}
+	return f;
+}
+
+static void dect_record_finish(FILE *f, unsigned int rate, uint32_t samples)
+{
+	uint8_t h[DECT_WAV_HEADER_MAX_SIZE];
+	unsigned int len;
+
+	len = dect_wav_header_init(h, rate ? rate : DECT_RECORD_DEFAULT_RATE,
+				   samples);
+	if (samples * dect_record_formats[dect_record_format].size & 1)
+		fputc(0, f);
+	if (fseek(f, 0, SEEK_SET) == 0)
+		fwrite(h, len, 1, f);
+	fclose(f);
+}
+
+static void dect_record_write(struct dect_audio_sink *sink, unsigned int dir,
+			      uint32_t seq, const int16_t *samples,
+			      unsigned int n, bool voice)
+{
+	struct dect_record *rec = container_of(sink, struct dect_record, sink);
+	int16_t buf[DECT_AUDIO_MAX_FRAME_SAMPLES];
+	uint8_t enc[DECT_AUDIO_MAX_FRAME_SAMPLES];
+	const void *data = buf;
+	size_t size;
+	unsigned int i;
+
+	if (rec->rate[dir] == 0)
+		rec->rate[dir] = n * DECT_AUDIO_FRAME_RATE;
+	if (!voice && dect_record_skip_silence)
+		return;
+	n = dect_audio_resample(buf, rec->rate[dir] / DECT_AUDIO_FRAME_RATE,
+				samples, n, &rec->prev[dir]);
+
+	switch (dect_record_format) {
+	case DECT_RECORD_PCM:
+		for (i = 0; i < n; i++)
+			buf[i] = htole16(buf[i]);
+		size = n * sizeof(buf[0]);
+		break;
+	case DECT_RECORD_ALAW:
+		dect_alaw_encode(enc, buf, n);
+		data = enc;
+		size = n;
+		break;
+	case DECT_RECORD_ULAW:
+		dect_ulaw_encode(enc, buf, n);
+		data = enc;
+		size = n;
+		break;
+	default:
+		return;
+	}
+
+	if (fwrite(data, size, 1, rec->file[dir]) == 1)
+		rec->samples[dir] += n;
+}
+
+static void dect_record_close(struct dect_audio_sink *sink)
+{
+	struct dect_record *rec = container_of(sink, struct dect_record, sink);
+	unsigned int i;
+
+	for (i = 0; i < array_size(rec->file); i++)
+		dect_record_finish(rec->file[i], rec->rate[i], rec->samples[i]);
+	free(rec);
+}
+
+static const struct dect_audio_sink_ops dect_record_ops = {
+	.write		= dect_record_write,
+	.close		= dect_record_close,
+};
+
+struct dect_audio_sink *dect_record_open(const char *cluster,
+					 const struct dect_pt *pt)
+{
+	const struct dect_ipui *ipui = &pt->portable_identity->ipui;
+	char ipei[DECT_IPEI_STRING_LEN + 1] = "unknown";
+	char prefix[PATH_MAX], date[32];
+	struct dect_record *rec;
+	struct tm tm;
+	time_t now;
+	unsigned int i;
+
+	rec = calloc(1, sizeof(*rec));
+	if (rec == NULL)
+		goto err1;
+	rec->sink.ops = &dect_record_ops;
+
+	if (ipui->put == DECT_IPUI_N)
+		dect_format_ipei_string(&ipui->pun.n.ipei, ipei);
+	now = time(NULL);
+	strftime(date, sizeof(date), "%Y%m%d-%H%M%S", localtime_r(&now, &tm));
+	snprintf(prefix, sizeof(prefix), "%s/%s-%s-%s", dect_record_dir,
+		 cluster ? cluster : "dect", ipei, date);
+
+	for (i = 0; i < array_size(rec->file); i++) {
+		rec->file[i] = dect_record_create(prefix, i);
+		if (rec->file[i] == NULL)
+			goto err2;
+	}
+	return &rec->sink;
+
+err2:
+	dectmon_log("failed to create recording %s: %s\n",
+		    prefix, strerror(errno));
+	while (i-- > 0)
+		fclose(rec->file[i]);
+	free(rec);
+err1:
+	return NULL;
+}
@@ -0,0 +1,203 @@
+/*
+ * dectmon RTP call audio streaming
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+
+#include <dectmon.h>
+#include <audio.h>
+#include <rtp.h>
+
+const char *dect_rtp_dest;
+
+static struct sockaddr_storage rtp_addr;
+static socklen_t rtp_addrlen;
+static uint32_t rtp_streams;
+
+static int dect_rtp_parse_udp(const char *dest)
+{
+	struct addrinfo hints, *res;
+	char buf[256], *host, *port;
+	size_t len;
+
+	snprintf(buf, sizeof(buf), "%s", dest);
+	port = strrchr(buf, ':');
+	if (port == NULL)
+		return -1;
+	*port++ = '\0';
+
+	/* IPv6 addresses may be enclosed in brackets */
+	host = buf;
+	len  = strlen(host);
+	if (len >= 2 && host[0] == '[' && host[len - 1] == ']') {
+		host[len - 1] = '\0';
+		host++;
+	}
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	if (getaddrinfo(host, port, &hints, &res) != 0)
+		return -1;
+	memcpy(&rtp_addr, res->ai_addr, res->ai_addrlen);
+	rtp_addrlen = res->ai_addrlen;
+	freeaddrinfo(res);
+	return 0;
+}
+
+static int dect_rtp_parse_unix(const char *path)
+{
+	struct sockaddr_un *sun = (struct sockaddr_un *)&rtp_addr;
+
+	if (strlen(path) >= sizeof(sun->sun_path))
+		return -1;
+	sun->sun_family = AF_UNIX;
+	strcpy(sun->sun_path, path);
+	rtp_addrlen = sizeof(*sun);
+	return 0;
+}
+
+/* Parse the stream destination, either udp:HOST:PORT or unix:PATH */
+int dect_rtp_init(const char *dest)
+{
+	int err;
+
+	memset(&rtp_addr, 0, sizeof(rtp_addr));
+	if (!strncmp(dest, "udp:", 4))
+		err = dect_rtp_parse_udp(dest + 4);
+	else if (!strncmp(dest, "unix:", 5))
+		err = dect_rtp_parse_unix(dest + 5);
+	else
+		err = -1;
+
+	if (err < 0)
+		return -1;
+	dect_rtp_dest = dest;
+	return 0;
+}
+
+static void dect_rtp_flush(struct dect_audio_sink *sink)
+{
+	struct dect_rtp_stream *rs;
+	struct mmsghdr msgs[DECT_RTP_BATCH];
+	struct iovec iov[DECT_RTP_BATCH];
+	unsigned int i;
+	int sent;
+
+	rs = container_of(sink, struct dect_rtp_stream, sink);
+	if (rs->npkts == 0)
+		return;
+
+	memset(msgs, 0, rs->npkts * sizeof(msgs[0]));
+	for (i = 0; i < rs->npkts; i++) {
+		iov[i].iov_base = &rs->pkts[i];
+		iov[i].iov_len  = rs->len[i];
+		msgs[i].msg_hdr.msg_iov    = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	/* Packets not accepted by the socket are dropped */
+	sent = sendmmsg(rs->fd, msgs, rs->npkts, MSG_DONTWAIT);
+	if (sent < 0)
+		sent = 0;
+	rs->sent    += sent;
+	rs->dropped += rs->npkts - sent;
+	rs->npkts    = 0;
+}
+
+static void dect_rtp_write(struct dect_audio_sink *sink, unsigned int dir,
+			   uint32_t seq, const int16_t *samples,
+			   unsigned int n, bool voice)
+{
+	struct dect_rtp_stream *rs;
+	struct dect_rtp_packet *pkt;
+	unsigned int i;
+
+	rs = container_of(sink, struct dect_rtp_stream, sink);
+	if (rs->npkts == DECT_RTP_BATCH)
+		dect_rtp_flush(sink);
+
+	pkt = &rs->pkts[rs->npkts];
+	pkt->hdr.vpxcc = DECT_RTP_VERSION << 6;
+	pkt->hdr.mpt   = n * DECT_AUDIO_FRAME_RATE == 16000 ?
+			 DECT_RTP_PT_L16_16K : DECT_RTP_PT_L16_8K;
+	if (rs->samples[dir] != n) {
+		pkt->hdr.mpt |= DECT_RTP_MARKER;
+		rs->samples[dir] = n;
+	}
+	pkt->hdr.seq       = htons(seq);
+	pkt->hdr.timestamp = htonl(seq * n);
+	pkt->hdr.ssrc      = htonl(rs->ssrc[dir]);
+
+	for (i = 0; i < n; i++)
+		pkt->data[i] = htons(samples[i]);
+	rs->len[rs->npkts++] = sizeof(pkt->hdr) + n * sizeof(pkt->data[0]);
+}
+
+static void dect_rtp_close(struct dect_audio_sink *sink)
+{
+	struct dect_rtp_stream *rs;
+
+	rs = container_of(sink, struct dect_rtp_stream, sink);
+	dect_rtp_flush(sink);
+	dectmon_log("rtp stream %08x/%08x: sent %lu dropped %lu\n",
+		    rs->ssrc[0], rs->ssrc[1], rs->sent, rs->dropped);
+	close(rs->fd);
+	free(rs);
+}
+
+static const struct dect_audio_sink_ops dect_rtp_ops = {
+	.write		= dect_rtp_write,
+	.flush		= dect_rtp_flush,
+	.close		= dect_rtp_close,
+};
+
+struct dect_audio_sink *dect_rtp_open(void)
+{
+	struct dect_rtp_stream *rs;
+	struct timeval tv;
+	uint32_t id;
+
+	rs = calloc(1, sizeof(*rs));
+	if (rs == NULL)
+		goto err1;
+	rs->sink.ops = &dect_rtp_ops;
+
+	rs->fd = socket(rtp_addr.ss_family,
+			SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (rs->fd < 0)
+		goto err2;
+	if (connect(rs->fd, (struct sockaddr *)&rtp_addr, rtp_addrlen) < 0)
+		goto err3;
+
+	/* SSRCs only need to be unique among the streams of this process */
+	gettimeofday(&tv, NULL);
+	id = __atomic_add_fetch(&rtp_streams, 1, __ATOMIC_RELAXED);
+	rs->ssrc[0] = (tv.tv_sec << 20 ^ tv.tv_usec) + id * 2 * 0x9e3779b9;
+	rs->ssrc[1] = rs->ssrc[0] + 0x9e3779b9;
+	return &rs->sink;
+
+err3:
+	close(rs->fd);
+err2:
+	dectmon_log("failed to open rtp stream %s: %s\n",
+		    dect_rtp_dest, strerror(errno));
+	free(rs);
+err1:
+	return NULL;
+}
@@ -0,0 +1,393 @@
+/*
+ * dectmon scan coordinator
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <dect/libdect.h>
+#include <dectmon.h>
+#include <utils.h>
+#include <ops.h>
+#include <scan.h>
+
+/*
+ * FPs discovered by any receiver are kept in a shared table. Idle receivers
+ * are assigned distinct FPs, either directly when they discover one
+ * themselves or by queueing the assignment to their event loop when it
+ * was discovered by a different receiver. FPs failing to lock repeatedly
+ * are blacklisted for some time.
+ *
+ * All coordinator state, including the scan state of the receivers, is
+ * protected by scan_lock, which nests inside the receivers' loop locks.
+ */
+#define SCAN_HASH_BITS		6
+#define SCAN_HASH_SIZE		(1 << SCAN_HASH_BITS)
+
+#define scan_log(priv, fmt, args...) \
+	dectmon_log("%s: " fmt, (priv)->cluster ? (priv)->cluster : "default", \
+		    ## args)
+
+struct dect_scan_fp {
+	struct hlist_node		hnode;
+	struct list_head		list;
+	struct dect_ari			pari;
+	struct dect_handle_priv		*owner;
+	unsigned int			failures;
+	uint64_t			blacklisted;
+};
+
+bool scan;
+
+static pthread_mutex_t scan_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct hlist_head scan_fp_hash[SCAN_HASH_SIZE];
+static LIST_HEAD(scan_fps);
+static LIST_HEAD(scan_idle);
+
+static unsigned int scan_locked;
+static unsigned int scan_locks;
+static unsigned int scan_timeouts;
+static uint64_t scan_ttl_sum;
+static uint64_t scan_ttl_min;
+static uint64_t scan_ttl_max;
+
+/* Milliseconds */
+static uint64_t dect_scan_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+/* The FPN is part of the ARIs of all access rights classes */
+static unsigned int dect_scan_hash(const struct dect_ari *pari)
+{
+	return (pari->fpn * 0x9e3779b1U) >> (32 - SCAN_HASH_BITS);
+}
+
+static struct dect_scan_fp *dect_scan_fp_get(const struct dect_handle_priv *priv,
+					     const struct dect_ari *pari)
+{
+	struct hlist_head *head = &scan_fp_hash[dect_scan_hash(pari)];
+	struct dect_scan_fp *fp;
+	struct hlist_node *n;
+
+	hlist_for_each_entry(fp, n, head, hnode)
+		if (!dect_ari_cmp(pari, &fp->pari))
+			return fp;
+
+	fp = calloc(1, sizeof(*fp));
+	if (fp == NULL)
+		return NULL;
+	fp->pari = *pari;
+	hlist_add_head(&fp->hnode, head);
+	list_add_tail(&fp->list, &scan_fps);
+
+	scan_log(priv, "discovered EMC: %.4x FPN: %.5x\n", pari->emc, pari->fpn);
+	return fp;
+}
+
+static bool dect_scan_fp_available(const struct dect_scan_fp *fp, uint64_t now)
+{
+	return fp->owner == NULL && now >= fp->blacklisted;
+}
+
+static struct dect_scan_fp *dect_scan_fp_next(const struct dect_scan_fp *exclude,
+					      uint64_t now)
+{
+	struct dect_scan_fp *fp;
+
+	list_for_each_entry(fp, &scan_fps, list) {
+		if (fp != exclude && dect_scan_fp_available(fp, now))
+			return fp;
+	}
+	return NULL;
+}
+
+static void dect_scan_assign(struct dect_handle_priv *priv,
+			     struct dect_scan_fp *fp, uint64_t now)
+{
+	struct dect_scan_receiver *r = &priv->scan;
+
+	list_del_init(&r->list);
+	r->state = DECT_SCAN_LOCKING;
+	r->fp	 = fp;
+	r->start = now;
+	fp->owner = priv;
+}
+
+/* Called by the receiver's thread after assignment of an FP */
+static void dect_scan_lock_req(struct dect_handle_priv *priv,
+			       const struct dect_ari *pari)
+{
+	priv->pari = *pari;
+	dect_llme_mac_me_info_res(priv->dh, pari);
+	dect_timer_start(priv->dh, priv->lock_timer, DECT_LOCK_TIMEOUT);
+}
+
+static void dect_scan_work(struct dect_loop_work *work)
+{
+	struct dect_handle_priv *priv;
+	struct dect_ari pari;
+
+	priv = container_of(work, struct dect_handle_priv, scan.work);
+
+	pthread_mutex_lock(&scan_lock);
+	if (priv->scan.state != DECT_SCAN_LOCKING || priv->scan.fp == NULL) {
+		pthread_mutex_unlock(&scan_lock);
+		return;
+	}
+	pari = priv->scan.fp->pari;
+	pthread_mutex_unlock(&scan_lock);
+
+	dect_scan_lock_req(priv, &pari);
+}
+
+/* Hand available FPs to idle receivers, called with scan_lock held */
+static void dect_scan_dispatch(const struct dect_scan_fp *exclude, uint64_t now)
+{
+	struct dect_handle_priv *priv, *next;
+	struct dect_scan_fp *fp;
+
+	list_for_each_entry_safe(priv, next, &scan_idle, scan.list) {
+		fp = dect_scan_fp_next(exclude, now);
+		if (fp == NULL)
+			break;
+		dect_scan_assign(priv, fp, now);
+		dect_loop_queue_work(priv->loop, &priv->scan.work);
+	}
+}
+
+/*
+ * Receiver became idle: pick the next available FP, preferrably a different
+ * one than the last, or resume scanning.
+ */
+static void dect_scan_idle(struct dect_handle_priv *priv,
+			   const struct dect_scan_fp *last)
+{
+	struct dect_scan_receiver *r = &priv->scan;
+	struct dect_scan_fp *fp;
+	uint64_t now = dect_scan_now();
+	struct dect_ari pari;
+
+	memset(&priv->pari, 0, sizeof(priv->pari));
+	priv->locked = false;
+	dect_llme_scan_req(priv->dh);
+
+	pthread_mutex_lock(&scan_lock);
+	fp = dect_scan_fp_next(last, now);
+	if (fp != NULL) {
+		dect_scan_assign(priv, fp, now);
+		pari = fp->pari;
+		pthread_mutex_unlock(&scan_lock);
+
+		dect_scan_lock_req(priv, &pari);
+		return;
+	}
+
+	r->state = DECT_SCAN_IDLE;
+	r->fp	 = NULL;
+	list_add_tail(&r->list, &scan_idle);
+
+	/* The last FP may still be taken by a different receiver */
+	dect_scan_dispatch(NULL, now);
+	pthread_mutex_unlock(&scan_lock);
+}
+
+static void dect_scan_lock_timer(struct dect_handle *dh,
+				 struct dect_timer *timer)
+{
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	struct dect_scan_fp *fp;
+
+	pthread_mutex_lock(&scan_lock);
+	fp = priv->scan.fp;
+	fp->owner = NULL;
+	scan_timeouts++;
+
+	if (++fp->failures >= DECT_SCAN_MAX_FAILURES) {
+		fp->blacklisted = dect_scan_now() + DECT_SCAN_BLACKLIST_TIME * 1000;
+		fp->failures	= 0;
+		scan_log(priv, "timeout, blacklisting EMC: %.4x FPN: %.5x\n",
+			 fp->pari.emc, fp->pari.fpn);
+	} else
+		scan_log(priv, "timeout, lock failed\n");
+	pthread_mutex_unlock(&scan_lock);
+
+	dect_scan_idle(priv, fp);
+}
+
+/* The state is checked under scan_lock, it may be changed by other receivers */
+static void dect_scan_locked(struct dect_handle_priv *priv)
+{
+	struct dect_scan_receiver *r = &priv->scan;
+	uint64_t ttl;
+	unsigned int n;
+
+	pthread_mutex_lock(&scan_lock);
+	if (r->state != DECT_SCAN_LOCKING) {
+		pthread_mutex_unlock(&scan_lock);
+		return;
+	}
+	r->state = DECT_SCAN_LOCKED;
+	r->fp->failures = 0;
+
+	ttl = dect_scan_now() - r->start;
+	if (scan_locks == 0 || ttl < scan_ttl_min)
+		scan_ttl_min = ttl;
+	if (ttl > scan_ttl_max)
+		scan_ttl_max = ttl;
+	scan_ttl_sum += ttl;
+	scan_locks++;
+	n = ++scan_locked;
+	pthread_mutex_unlock(&scan_lock);
+
+	dect_timer_stop(priv->dh, priv->lock_timer);
+	priv->locked = true;
+	scan_log(priv, "locked (%u): EMC: %.4x FPN: %.5x in %llums\n",
+		 n, priv->pari.emc, priv->pari.fpn, (unsigned long long)ttl);
+}
+
+static void dect_scan_unlocked(struct dect_handle_priv *priv)
+{
+	struct dect_scan_fp *fp;
+	unsigned int n;
+
+	pthread_mutex_lock(&scan_lock);
+	if (priv->scan.state != DECT_SCAN_LOCKED) {
+		pthread_mutex_unlock(&scan_lock);
+		return;
+	}
+	fp = priv->scan.fp;
+	fp->owner = NULL;
+	n = --scan_locked;
+	pthread_mutex_unlock(&scan_lock);
+
+	scan_log(priv, "unlocked (%u): EMC: %.4x FPN: %.5x\n",
+		 n, priv->pari.emc, priv->pari.fpn);
+	dect_scan_idle(priv, fp);
+}
+
+static void dect_mac_me_info_ind(struct dect_handle *dh,
+				 const struct dect_ari *pari,
+				 const struct dect_fp_capabilities *fpc)
+{
+	struct dect_handle_priv *priv = dect_handle_priv(dh);
+	struct dect_scan_receiver *r = &priv->scan;
+	struct dect_scan_fp *fp;
+	uint64_t now;
+
+	if (!scan)
+		return;
+
+	if (pari != NULL) {
+		now = dect_scan_now();
+
+		pthread_mutex_lock(&scan_lock);
+		fp = dect_scan_fp_get(priv, pari);
+		if (fp != NULL && r->state == DECT_SCAN_IDLE &&
+		    dect_scan_fp_available(fp, now)) {
+			dect_scan_assign(priv, fp, now);
+			pthread_mutex_unlock(&scan_lock);
+
+			dect_scan_lock_req(priv, pari);
+			return;
+		}
+		dect_scan_dispatch(NULL, now);
+		pthread_mutex_unlock(&scan_lock);
+	} else if (fpc->fpc != 0)
+		dect_scan_locked(priv);
+	else
+		dect_scan_unlocked(priv);
+}
+
+struct dect_llme_ops_ dect_scan_llme_ops = {
+	.mac_me_info_ind	= dect_mac_me_info_ind,
+};
+
+int dect_scan_open(struct dect_handle_priv *priv)
+{
+	priv->lock_timer = dect_timer_alloc(priv->dh);
+	if (priv->lock_timer == NULL)
+		return -1;
+	dect_timer_setup(priv->lock_timer, dect_scan_lock_timer, priv);
+
+	init_list_head(&priv->scan.list);
+	priv->scan.work.func = dect_scan_work;
+	return 0;
+}
+
+void dect_scan_close(struct dect_handle_priv *priv)
+{
+	if (dect_timer_running(priv->lock_timer))
+		dect_timer_stop(priv->dh, priv->lock_timer);
+	dect_timer_free(priv->dh, priv->lock_timer);
+}
+
+void dect_scan_start(struct dect_handle_priv *priv)
+{
+	if (scan)
+		dect_scan_idle(priv, NULL);
+}
+
+/* Release the receiver's FP and hand it to a different receiver */
+void dect_scan_stop(struct dect_handle_priv *priv)
+{
+	struct dect_scan_receiver *r = &priv->scan;
+
+	pthread_mutex_lock(&scan_lock);
+	list_del_init(&r->list);
+	if (r->fp != NULL) {
+		if (r->state == DECT_SCAN_LOCKED)
+			scan_locked--;
+		r->fp->owner = NULL;
+		r->fp = NULL;
+	}
+	r->state = DECT_SCAN_IDLE;
+	dect_scan_dispatch(NULL, dect_scan_now());
+	pthread_mutex_unlock(&scan_lock);
+}
+
+void dect_scan_show(void)
+{
+	const struct dect_scan_fp *fp;
+	uint64_t now = dect_scan_now();
+	const char *state, *owner;
+
+	pthread_mutex_lock(&scan_lock);
+	dectmon_log("PARI\t\t\tState\t\tReceiver\tFailures\n");
+	list_for_each_entry(fp, &scan_fps, list) {
+		owner = "-";
+		if (fp->owner != NULL) {
+			owner = fp->owner->cluster ? fp->owner->cluster : "default";
+			state = fp->owner->scan.state == DECT_SCAN_LOCKED ?
+				"locked" : "locking";
+		} else if (now < fp->blacklisted)
+			state = "blacklisted";
+		else
+			state = "available";
+
+		dectmon_log("EMC: %.4x FPN: %.5x\t%-12s\t%-12s\t%u\n",
+			    fp->pari.emc, fp->pari.fpn, state, owner,
+			    fp->failures);
+	}
+
+	dectmon_log("Locked: %u Locks: %u Timeouts: %u\n",
+		    scan_locked, scan_locks, scan_timeouts);
+	if (scan_locks)
+		dectmon_log("Time to lock (ms): min %llu avg %llu max %llu\n",
+			    (unsigned long long)scan_ttl_min,
+			    (unsigned long long)(scan_ttl_sum / scan_locks),
+			    (unsigned long long)scan_ttl_max);
+	pthread_mutex_unlock(&scan_lock);
+}
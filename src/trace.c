@@ -0,0 +1,172 @@
+/*
+ * dectmon receive path latency tracing
+ *
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <dectmon.h>
+#include <utils.h>
+#include <trace.h>
+
+/*
+ * Latencies are aggregated in log-linear histograms: values below
+ * TRACE_SUB_BUCKETS nanoseconds are counted exactly, larger values in
+ * TRACE_SUB_BUCKETS buckets per power of two, bounding the relative
+ * error to 1/TRACE_SUB_BUCKETS.
+ */
+#define TRACE_SUB_BITS		4
+#define TRACE_SUB_BUCKETS	(1 << TRACE_SUB_BITS)
+#define TRACE_MAX_SHIFT		32
+#define TRACE_BUCKETS		((TRACE_MAX_SHIFT + 1) * TRACE_SUB_BUCKETS)
+
+/* Processing time available per slot in nanoseconds */
+#define TRACE_SLOT_BUDGET	(1000000000ULL / \
+				 (DECT_FRAMES_PER_SECOND * DECT_FRAME_SIZE))
+
+struct dect_trace_hist {
+	uint64_t			count;
+	uint64_t			sum;
+	uint64_t			max;
+	uint64_t			buckets[TRACE_BUCKETS];
+};
+
+static const char * const dect_trace_stage_names[__DECT_TRACE_MAX] = {
+	[DECT_TRACE_MAC]		= "MAC",
+	[DECT_TRACE_DLC]		= "DLC",
+	[DECT_TRACE_NWK]		= "NWK",
+	[DECT_TRACE_AUDIO]		= "AUDIO",
+	[DECT_TRACE_FRAME]		= "FRAME",
+};
+
+/*
+ * Cluster threads record into the shared histograms using atomic
+ * operations, the start timestamp is tracked per thread.
+ */
+bool dect_trace_enabled;
+static __thread uint64_t dect_trace_start;
+static uint64_t dect_trace_overruns;
+static struct dect_trace_hist dect_trace_hist[__DECT_TRACE_MAX];
+
+static uint64_t dect_trace_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static unsigned int dect_trace_bucket(uint64_t val)
+{
+	unsigned int shift;
+
+	if (val < TRACE_SUB_BUCKETS)
+		return val;
+
+	shift = fls(val) - TRACE_SUB_BITS - 1;
+	if (shift >= TRACE_MAX_SHIFT)
+		return TRACE_BUCKETS - 1;
+	return (shift + 1) * TRACE_SUB_BUCKETS + (val >> shift) -
+	       TRACE_SUB_BUCKETS;
+}
+
+static uint64_t dect_trace_bucket_val(unsigned int bucket)
+{
+	unsigned int shift;
+
+	if (bucket < TRACE_SUB_BUCKETS)
+		return bucket;
+
+	shift = bucket / TRACE_SUB_BUCKETS - 1;
+	return (uint64_t)(bucket % TRACE_SUB_BUCKETS + TRACE_SUB_BUCKETS) << shift;
+}
+
+void __dect_trace_frame_start(void)
+{
+	dect_trace_start = dect_trace_now();
+}
+
+void __dect_trace_stage(enum dect_trace_stages stage)
+{
+	struct dect_trace_hist *h = &dect_trace_hist[stage];
+	uint64_t lat, max;
+
+	if (dect_trace_start == 0)
+		return;
+	lat = dect_trace_now() - dect_trace_start;
+
+	__atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&h->sum, lat, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&h->buckets[dect_trace_bucket(lat)], 1,
+			   __ATOMIC_RELAXED);
+
+	max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+	while (lat > max &&
+	       !__atomic_compare_exchange_n(&h->max, &max, lat, true,
+					    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+
+	if (stage == DECT_TRACE_FRAME) {
+		if (lat > TRACE_SLOT_BUDGET)
+			__atomic_fetch_add(&dect_trace_overruns, 1,
+					   __ATOMIC_RELAXED);
+		dect_trace_start = 0;
+	}
+}
+
+static double dect_trace_percentile(const struct dect_trace_hist *h,
+				    unsigned int permille)
+{
+	uint64_t cnt = 0, thresh;
+	unsigned int i;
+
+	thresh = div_round_up(h->count * permille, 1000);
+	for (i = 0; i < TRACE_BUCKETS; i++) {
+		cnt += h->buckets[i];
+		if (cnt >= thresh)
+			break;
+	}
+	return dect_trace_bucket_val(i) / 1000.0;
+}
+
+void dect_trace_show(void)
+{
+	const struct dect_trace_hist *h;
+	unsigned int i;
+
+	dectmon_log("Stage\tCount\t\tMean\tp50\tp90\tp99\tp99.9\tMax (us)\n");
+	for (i = 0; i < array_size(dect_trace_hist); i++) {
+		h = &dect_trace_hist[i];
+		if (h->count == 0) {
+			dectmon_log("%s\t0\n", dect_trace_stage_names[i]);
+			continue;
+		}
+
+		dectmon_log("%s\t%-12llu\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n",
+			    dect_trace_stage_names[i],
+			    (unsigned long long)h->count,
+			    (double)h->sum / h->count / 1000.0,
+			    dect_trace_percentile(h, 500),
+			    dect_trace_percentile(h, 900),
+			    dect_trace_percentile(h, 990),
+			    dect_trace_percentile(h, 999),
+			    h->max / 1000.0);
+	}
+	dectmon_log("Frames exceeding slot budget (%lluus): %llu\n",
+		    TRACE_SLOT_BUDGET / 1000,
+		    (unsigned long long)dect_trace_overruns);
+}
+
+void dect_trace_reset(void)
+{
+	memset(dect_trace_hist, 0, sizeof(dect_trace_hist));
+	dect_trace_overruns = 0;
+}